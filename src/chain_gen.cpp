@@ -0,0 +1,171 @@
+#include "chain_gen.h"
+
+#include <fstream>
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+
+bool read_chain_file(const string &path, vector<Task> &taskchain, vector<WHconstr> &setofmk, vector<int> &mktaskid)
+{
+	ifstream infile(path);
+	if (!infile.is_open())
+		return false;
+
+	// Initialize appo variables
+	int id, period, deadline;
+	bool mktask;
+
+	taskchain.clear();
+	setofmk.clear();
+	mktaskid.clear();
+
+	// Start reading data from input file
+	string str;
+	getline(infile, str); // skip the first line
+
+	while (infile >> id >> period >> deadline >> mktask) {
+
+		// Create task chain
+		Task t;
+		t.id = id;
+		t.period = period;
+		t.deadline = deadline;
+		taskchain.push_back(t);
+
+		// Create mk model
+		MKconstr mkc;
+		WHconstr whc;
+
+		// Initialize everything hard deadline
+		mkc.m = 0;
+		mkc.k = 1;
+
+		// Store id of task with weakly-hard behavior
+		if (mktask)
+			mktaskid.push_back(id);
+
+		// Add mk parameters to list
+		whc.taskid = id;
+		whc.mconsec = mkc.m;
+		whc.mk.push_back(mkc);
+		setofmk.push_back(whc);
+	}
+
+	return true;
+}
+
+
+void set_weakly_hard(vector<WHconstr> &setofmk, const vector<int> &mktaskid, int m, int k)
+{
+	for (int j = 0; j < mktaskid.size(); j++) {
+		setofmk.at(mktaskid.at(j)).mconsec = m;
+		setofmk.at(mktaskid.at(j)).mk.at(0).k = k;
+		setofmk.at(mktaskid.at(j)).mk.at(0).m = m;
+	}
+}
+
+
+void random_chain(mt19937 &rng, const ChainGenParams &params, vector<Task> &taskchain, vector<WHconstr> &setofmk)
+{
+	const int NUM_TASKS = params.num_tasks;
+	const int CHOSEN_K = params.chosen_k;
+
+	//-------------------------------------------------------------
+	// Store chosen periods
+	vector<int> chosen_periods;
+
+	// Build random set of periods
+	if (params.periods_in_bucket) {
+		// Periods to choose from (automotive standard, ms)
+		vector<int> period_bucket = { 1, 2, 5, 10, 20, 25, 50, 100 };
+
+		int TOT_NUM_PERIODS = period_bucket.size();
+		uniform_int_distribution<int> uni(0, TOT_NUM_PERIODS - 1); // guaranteed unbiased
+
+		for (int i = 0; i < NUM_TASKS; i++) {
+			// Choose random period id
+			int appo_id = uni(rng);
+			chosen_periods.push_back(period_bucket.at(appo_id));
+		}
+	}
+
+	else { // Random periods
+
+		uniform_int_distribution<int> uni(1, params.max_period); // guaranteed unbiased
+
+		for (int i = 0; i < NUM_TASKS; i++) {
+			// Choose random period
+			int rand_period = uni(rng);
+			chosen_periods.push_back(rand_period);
+		}
+	}
+
+	// Reorder periods if required
+	switch (params.rule) {
+	case UN:
+		sort(chosen_periods.begin(), chosen_periods.end());
+		break;
+	case OV:
+		sort(chosen_periods.rbegin(), chosen_periods.rend());
+		break;
+	default:
+		break;
+	}
+
+	//-------------------------------------------------------------
+	// Create tasks in chain
+
+	taskchain.clear();
+
+	for (int i = 0; i < NUM_TASKS; i++) {
+		Task t;
+		t.id = i;
+		t.period = chosen_periods.at(i);
+		t.deadline = t.period;
+		taskchain.push_back(t);
+	}
+
+	//-------------------------------------------------------------
+	// Assign (m,k) values
+
+	setofmk.clear();
+
+	uniform_int_distribution<int> uni(3, CHOSEN_K); // guaranteed unbiased
+
+	for (int i = 0; i < NUM_TASKS; i++) {
+		MKconstr mkc;
+		WHconstr whc;
+
+		mkc.k = uni(rng);
+		mkc.m = 0;
+
+		// Select m depending on the chosen value K and assignment rule
+		switch (params.mktasks) {
+		case TOP:
+			if (i < NUM_TASKS / 3)
+				mkc.m = floor(static_cast<double>(CHOSEN_K) / 3.0);
+			break;
+		case MID:
+			if (i >= NUM_TASKS / 3 && i < 2 * NUM_TASKS / 3)
+				mkc.m = floor(static_cast<double>(CHOSEN_K) / 3.0);
+			break;
+		case BOT:
+			if (i >= 2 * NUM_TASKS / 3)
+				mkc.m = floor(static_cast<double>(CHOSEN_K) / 3.0);
+			break;
+		case MIX:
+			mkc.m = floor(static_cast<double>(CHOSEN_K) / 3.0);
+			break;
+		}
+
+		// Consecutive deadline misses
+		whc.taskid = i;
+		whc.mconsec = mkc.m;
+
+		// Add weakly-hard constraint to set
+		whc.mk.push_back(mkc);
+		setofmk.push_back(whc);
+	}
+}
@@ -0,0 +1,35 @@
+#ifndef CHAIN_GEN_H__
+#define CHAIN_GEN_H__
+
+#include <vector>
+#include <string>
+#include <random>
+
+#include "milp_data.h"
+
+//-----------------------------------------------------------------------------
+// Chains of the experiments: input files (perceptin*.txt) and pseudo-random chains
+//-----------------------------------------------------------------------------
+
+struct ChainGenParams {
+	int num_tasks = 5;
+	bool periods_in_bucket = false;	// automotive periods instead of uniform in [1, max_period]
+	int max_period = 100;			// ms
+	int chosen_k = 10;				// k drawn in [3, chosen_k], m = chosen_k / 3 for the weakly-hard tasks
+	PeriodsRule rule = MX;
+	mkTasks mktasks = MIX;
+};
+
+// Reads a chain file (header line, then id period deadline mktask per task). Every task is hard,
+// ids of the tasks marked as weakly-hard are returned in mktaskid. False if the file cannot be read.
+bool read_chain_file(const std::string &path, std::vector<Task> &taskchain, std::vector<WHconstr> &setofmk,
+	std::vector<int> &mktaskid);
+
+// Sets mconsec = m and a single (m,k) on the listed tasks
+void set_weakly_hard(std::vector<WHconstr> &setofmk, const std::vector<int> &mktaskid, int m, int k);
+
+// Pseudo-random chain with implicit deadlines
+void random_chain(std::mt19937 &rng, const ChainGenParams &params, std::vector<Task> &taskchain,
+	std::vector<WHconstr> &setofmk);
+
+#endif
@@ -0,0 +1,48 @@
+#include "milp_daemon.h"
+#include <iostream>
+#include <csignal>
+#include <cstdlib>
+#include <thread>
+#include <pthread.h>
+
+using namespace std;
+
+// Usage: whchaind [socket_path] [workers] [solver_threads]
+int main(int argc, char *argv[])
+{
+	DaemonConfig config;
+
+	if (argc > 1)
+		config.socket_path = argv[1];
+	config.workers = (argc > 2) ? atoi(argv[2]) : max(1u, thread::hardware_concurrency());
+	config.solver_threads = (argc > 3) ? atoi(argv[3]) : 1;
+
+	// Handle termination in this thread only
+	sigset_t sigs;
+	sigemptyset(&sigs);
+	sigaddset(&sigs, SIGINT);
+	sigaddset(&sigs, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &sigs, NULL);
+	signal(SIGPIPE, SIG_IGN);
+
+	AnalysisServer server(config);
+
+	int status = 0;
+	thread serving([&server, &status] { status = server.run(); });
+
+	// Stop on signal, or as soon as the server gives up
+	thread watcher([&sigs, &server] {
+		int sig;
+		sigwait(&sigs, &sig);
+		server.stop();
+	});
+	watcher.detach();
+
+	cout << "[DAEMON] Serving on " << config.socket_path << " with " << config.workers << " workers" << endl;
+	serving.join();
+
+	if (status != 0)
+		cerr << "[DAEMON] Cannot listen on " << config.socket_path << endl;
+
+	return status == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
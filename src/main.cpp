@@ -1,10 +1,13 @@
 #include "milp_WHchain.h"
+#include "milp_store.h"
+#include "chain_gen.h"
 #include <random>
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <assert.h>
 #include <chrono>
+#include <climits>
 
 using namespace std;
 
@@ -21,6 +24,9 @@ using namespace std;
 #define MYPERRULE 2
 #define MYMKTASKS 3
 
+// Columnar store with inputs and results of every analysis (see milp_store.h)
+#define RESULTS_STORE "results.whrs"
+
 
 int main()
 {
@@ -40,6 +46,22 @@ int main()
 	std::vector<Task> taskchain;
 	std::vector<WHconstr> setofmk;
 
+	// Analysis settings of the experiments
+	MILPoptions opts;
+	opts.verbose = true;
+	opts.export_model = "qcpex1.lp";
+	opts.results_file = "results.txt";
+
+	ResultsWriter store(RESULTS_STORE);
+
+	// Pseudo-random chains
+	ChainGenParams genparams;
+	genparams.num_tasks = NUM_TASKS;
+	genparams.periods_in_bucket = PERIODS_IN_BUCKET;
+	genparams.chosen_k = CHOSEN_K;
+	genparams.rule = myPerRule;
+	genparams.mktasks = mymkTasks;
+
 
 	if (INPUT_FILE) { // Input file
 
@@ -80,70 +102,26 @@ int main()
 
 					// Read input file
 					std::string namefile = "perceptin";
-					ifstream infile(namefile + std::to_string(c) + ".txt");
+					vector<int> mktaskid;
 
-					if (!infile.is_open()) {
+					if (!read_chain_file(namefile + std::to_string(c) + ".txt", taskchain, setofmk, mktaskid)) {
 						exit(EXIT_FAILURE);
 					}
 
-					// Initialize appo variables
-					int id, period, deadline;
-					bool mktask;
-					vector<int> mktaskid;
-
-					taskchain.clear();
-					setofmk.clear();
-
-					// Start reading data from input file
-					string str;
-					getline(infile, str); // skip the first line
-
-					while (infile >> id >> period >> deadline >> mktask) {
-
-						// Create task chain
-						Task t;
-						t.id = id;
-						t.period = period;
-						t.deadline = deadline;
-						taskchain.push_back(t);
-
-						// Create mk model
-						MKconstr mkc;
-						WHconstr whc;
-
-						// Initialize everything hard deadline
-						mkc.m = 0;
-						mkc.k = 1;
-
-						// Store id of task with weakly-hard behavior
-						if (mktask)
-							mktaskid.push_back(id);
-
-						// Add mk parameters to list
-						whc.taskid = id;
-						whc.mconsec = mkc.m;
-						whc.mk.push_back(mkc);
-						setofmk.push_back(whc);
-
-					} // end reading file
-
-					  					  
-					for (int j = 0; j < mktaskid.size(); j++) {
-						// Update mk values
-						setofmk.at(mktaskid.at(j)).mconsec = m; // + j //for test VIII.C
-						setofmk.at(mktaskid.at(j)).mk.at(0).k = 50;
-						setofmk.at(mktaskid.at(j)).mk.at(0).m = m;  // + j //for test VIII.C
-					}
-					  
+					// Update mk values
+					set_weakly_hard(setofmk, mktaskid, m, 50); // + j //for test VIII.C
 
 					// Perform the test
 					OptTarget mytarget = static_cast<OptTarget>(i);
-					double output = MILP_WH_K(taskchain, setofmk, mytarget);
-					all_out << ',' << output;
+					MILPresult res = MILP_WH_K(taskchain, setofmk, mytarget, opts);
+					all_out << ',' << res.objective;
+
+					store.add_chain(taskchain, setofmk);
+					store.append(make_record(taskchain, setofmk, mytarget, res));
 
 				} // end test of chain
 
-				all_out << endl;
+				all_out << '\n';
 
 			} // end mk value 
 
@@ -173,109 +151,17 @@ int main()
 			tav.push_back(0);
 		}
 
+		// Execution times, one line per test
+		ofstream time_out;
+		string nameout = "exec_time_" + std::to_string(NUM_TASKS) + ".csv";
+		time_out.open(nameout, std::ios_base::app);
+
 		// Start tests
 		for (int s = 0; s < NUM_TESTS; s++) {
 
 
 			// Building the task set
-
-			//-------------------------------------------------------------
-			// Store chosen periods
-			vector<int> chosen_periods;
-
-			// Build random set of periods
-			if (PERIODS_IN_BUCKET) {
-				// Periods to choose from (automotive standard, ms)
-				vector<int> period_bucket = { 1, 2, 5, 10, 20, 25, 50, 100 };
-
-				int TOT_NUM_PERIODS = period_bucket.size();
-				std::uniform_int_distribution<int> uni(0, TOT_NUM_PERIODS - 1); // guaranteed unbiased
-
-				for (int i = 0; i < NUM_TASKS; i++) {
-					// Choose random period id					
-					int appo_id = uni(rng);
-					chosen_periods.push_back(period_bucket.at(appo_id));
-				}
-			}
-
-			else { // Random periods
-
-				// Maximum value for period (ms)
-				int MAX_T = 100;
-				std::uniform_int_distribution<int> uni(1, MAX_T); // guaranteed unbiased
-
-				for (int i = 0; i < NUM_TASKS; i++) {
-					// Choose random period
-
-					int rand_period = uni(rng);
-					chosen_periods.push_back(rand_period);
-				}
-			}
-
-
-			// Reorder periods if required
-			switch (myPerRule) {
-			case UN:
-				sort(chosen_periods.begin(), chosen_periods.end());
-				break;
-			case OV:
-				sort(chosen_periods.rbegin(), chosen_periods.rend());
-				break;
-			}
-
-			//-------------------------------------------------------------
-			// Create tasks in chain
-
-			taskchain.clear();
-
-			for (int i = 0; i < NUM_TASKS; i++) {
-				Task t;
-				t.id = i;
-				t.period = chosen_periods.at(i);
-				t.deadline = t.period;
-				taskchain.push_back(t);
-			}
-
-			//-------------------------------------------------------------
-			// Assign (m,k) values
-
-			setofmk.clear();
-
-			std::uniform_int_distribution<int> uni(3, CHOSEN_K); // guaranteed unbiased
-
-			for (int i = 0; i < NUM_TASKS; i++) {
-				MKconstr mkc;
-				WHconstr whc;
-
-				mkc.k = uni(rng);
-				mkc.m = 0;
-
-				// Select m depending on the chosen value K and assignment rule
-				switch (mymkTasks) {
-				case TOP:
-					if (i < NUM_TASKS / 3)
-						mkc.m = floor(static_cast<double>(CHOSEN_K) / 3.0);
-					break;
-				case MID:
-					if (i >= NUM_TASKS / 3 && i < 2 * NUM_TASKS / 3)
-						mkc.m = floor(static_cast<double>(CHOSEN_K) / 3.0);
-					break;
-				case BOT:
-					if (i >= 2 * NUM_TASKS / 3)
-						mkc.m = floor(static_cast<double>(CHOSEN_K) / 3.0);
-					break;
-				case MIX:
-					mkc.m = floor(static_cast<double>(CHOSEN_K) / 3.0);
-					break;
-				}
-
-				// Consecutive deadline misses
-				whc.mconsec = mkc.m;
-
-				// Add weakly-hard constraint to set
-				whc.mk.push_back(mkc);
-				setofmk.push_back(whc);
-			}
+			random_chain(rng, genparams, taskchain, setofmk);
 
 			// Perform the test for all the metrics
 			for (int i = 0; i < 1; i++) {
@@ -284,9 +170,12 @@ int main()
 				cout << "********TEST NUMBER " << s << endl << endl;
 
 				auto start_time = chrono::steady_clock::now();
-				double output = MILP_WH_K(taskchain, setofmk, mytarget);
+				MILPresult res = MILP_WH_K(taskchain, setofmk, mytarget, opts);
 				auto end_time = chrono::steady_clock::now();
 
+				store.add_chain(taskchain, setofmk);
+				store.append(make_record(taskchain, setofmk, mytarget, res));
+
 				/*
 				all_out << output << ',';
 
@@ -299,16 +188,12 @@ int main()
 
 				double runtime = chrono::duration_cast<chrono::seconds>(end_time - start_time).count();
 
-				ofstream time_out;
-				string nameout = "exec_time_" + std::to_string(NUM_TASKS) + ".csv";
-				time_out.open(nameout, std::ios_base::app);
-
-				time_out << runtime << ',' << endl;
-
-				time_out.close();
+				time_out << runtime << ',' << '\n';
 
 			}
 		}
+
+		time_out.close();
 		
 
 		ofstream summary_out;
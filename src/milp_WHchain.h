@@ -12,10 +12,28 @@
 
 #include "milp_data.h"
 
+// Analysis of a chain held in memory. Thread-safe: each call owns its solver environment
+// and touches no file unless requested through the options.
+MILPresult MILP_WH_K(const std::vector<Task> &taskchain, const std::vector<WHconstr> &setofmk, OptTarget mytarget,
+	const MILPoptions &opts);
+
+// Solver environment kept warm across analyses. A workspace serves one thread at a time.
+struct MILPworkspace;
+MILPworkspace* MILP_create_workspace();
+void MILP_free_workspace(MILPworkspace *ws);
+
+// Same as above, building and solving the model in the environment of the workspace
+MILPresult MILP_WH_K(const std::vector<Task> &taskchain, const std::vector<WHconstr> &setofmk, OptTarget mytarget,
+	const MILPoptions &opts, MILPworkspace *ws);
+
+// Batch entry point: logs on stdout, exports the model and the solution table
 double MILP_WH_K(std::vector<Task> &taskchain, std::vector<WHconstr> &setofmk, OptTarget mytarget);
 //double MILP_WH_K_PATHS(std::vector<Task> &taskchain, std::vector<WHconstr> &setofmk, int num_paths, int chain_D);
 //int MILP_WH_SN(std::vector<Task> &taskchain, std::vector<WHconstr> &setofmk);
 
 std::string  convert_to_string(const int Number);
 
+// Hash of a chain and of its weakly-hard constraints (FNV-1a), stable across runs
+uint64_t chain_hash(const std::vector<Task> &taskchain, const std::vector<WHconstr> &setofmk);
+
 #endif
@@ -3,491 +3,277 @@
 #include <algorithm>   
 #include <vector>  
 #include <fstream>
+#include <sstream>
 #include <stdlib.h>     /* srand, rand */
 #include <time.h>       /* time */
+#include <chrono>
+#include <cmath>
 
 #include "milp_data.h"
 #include "milp_WHchain.h"
+#include "milp_presolve.h"
+#include "milp_race.h"
+#include "milp_tune.h"
+#include "milp_bulk.h"
+#include "milp_model.h"
 
 #define __DEBUG_MILP__ 1
 #define TOL 0.001
-#define TOL_OFFS 0.001
 
 using namespace std;
 
 ILOSTLBEGIN
 
-typedef IloArray<IloNumVarArray>   NumVarMatrix;
-typedef IloArray<IloIntVarArray>   IntVarMatrix;
-typedef IloArray<IntVarMatrix>     IntVar3Matrix;
 
+// Analyses run in a warm environment before it is rebuilt, to bound the memory held by
+// Concert containers that are not owned by the models
+#define WORKSPACE_RECYCLE 1000
 
-double MILP_WH_K(vector<Task> &taskchain, vector<WHconstr> &setofmk, OptTarget mytarget)
-{
-	//-----------------------------------------------------------------------------
-	// PROBLEM PARAMETERS
-	//-----------------------------------------------------------------------------
-
-	// Inputs from user
-	const int NUMBER_OF_PATHS = 2; 
-
-	// Number of tasks in a chain
-	const int NUMBER_OF_TASKS_IN_CHAIN = taskchain.size();
-
-	// Big-M (to represent infinity)
-	const double BIGM = INT_MAX;
-
-	//-----------------------------------------------------------------------------
-	// START MILP DESIGN
-	//-----------------------------------------------------------------------------
 
+struct MILPworkspace {
 	IloEnv env;
+	IloCplex cplex;
+	int num_analyses;
 
-	// MILP output
-	double MILP_out;
-
-
-#ifdef __DEBUG_MILP__
-	cout << "[MILP] Setting up variables...";
-#endif
-	try
-	{
-		IloModel model(env);
-
-		//----------------------------------------------------------------------------
-		// VARIABLES DEFINITION
-		//----------------------------------------------------------------------------
-
-		// Release offset of a task 
-		IloNumVarArray OFFS(env, NUMBER_OF_TASKS_IN_CHAIN);
-		for (int t = 0; t < NUMBER_OF_TASKS_IN_CHAIN; t++) {
-			string name = "OFFS" + convert_to_string(t);
-			int T = taskchain.at(t).period;
-			OFFS[t] = IloNumVar(env, 0.0, T - TOL_OFFS, name.c_str());
-		}
+	MILPworkspace() : cplex(env), num_analyses(0) {}
 
-		// Index of effective job
-		IntVarMatrix EFFECTIVEJOB(env, NUMBER_OF_TASKS_IN_CHAIN);
-		for (int t = 0; t < NUMBER_OF_TASKS_IN_CHAIN; t++) {
-			EFFECTIVEJOB[t] = IloIntVarArray(env, NUMBER_OF_PATHS);
-			for (unsigned int l = 0; l < NUMBER_OF_PATHS; l++) {
-				string name = "EID" + convert_to_string(t) + convert_to_string(l);
-				EFFECTIVEJOB[t][l] = IloIntVar(env, 0.0, UINT16_MAX, name.c_str());
-			}
-		}
+	~MILPworkspace() {
+		cplex.end();
+		env.end();
+	}
 
-		// Number of redundant jobs until a new input is available (R jobs)
-		IntVarMatrix REDUNDHITS(env, NUMBER_OF_TASKS_IN_CHAIN);
-		for (int t = 0; t < NUMBER_OF_TASKS_IN_CHAIN; t++) {
-			REDUNDHITS[t] = IloIntVarArray(env, NUMBER_OF_PATHS - 1);
-			for (unsigned int l = 0; l < NUMBER_OF_PATHS - 1; l++) {
-				string name = "nRED" + convert_to_string(t) + convert_to_string(l);
-				REDUNDHITS[t][l] = IloIntVar(env, 0.0, UINT16_MAX, name.c_str());
-			}
+	// Release a model after its solution, keeping the environment (and the solver) alive
+	void release(IloModel model, bool failed) {
+
+		cplex.clearModel();
+
+		IloExtractableArray owned(env);
+		for (IloModel::Iterator it(model); it.ok(); ++it)
+			owned.add(*it);
+		model.end();
+		owned.endElements();
+		owned.end();
+
+		num_analyses++;
+		if (failed || num_analyses >= WORKSPACE_RECYCLE) {
+			cplex.end();
+			env.end();
+			env = IloEnv();
+			cplex = IloCplex(env);
+			num_analyses = 0;
 		}
+	}
+};
 
-		// Number of missed jobs after the first input overwrite (M1 jobs)
-		IntVarMatrix MISSWNEWINPUT(env, NUMBER_OF_TASKS_IN_CHAIN);
-		for (int t = 0; t < NUMBER_OF_TASKS_IN_CHAIN; t++) {
-			MISSWNEWINPUT[t] = IloIntVarArray(env, NUMBER_OF_PATHS);
-			for (unsigned int l = 0; l < NUMBER_OF_PATHS; l++) {
-				string name = "nMISSni" + convert_to_string(t) + convert_to_string(l);
-				MISSWNEWINPUT[t][l] = IloIntVar(env, 0.0, UINT16_MAX, name.c_str());
-			}
-		}
 
-		// Number of V jobs
-		IntVarMatrix VOIDHITS(env, NUMBER_OF_TASKS_IN_CHAIN);
-		for (int t = 0; t < NUMBER_OF_TASKS_IN_CHAIN; t++) {
-			VOIDHITS[t] = IloIntVarArray(env, NUMBER_OF_PATHS - 1);
-			for (unsigned int l = 0; l < NUMBER_OF_PATHS - 1; l++) {
-				string name = "nINC" + convert_to_string(t) + convert_to_string(l);
-				VOIDHITS[t][l] = IloIntVar(env, 0.0, UINT16_MAX, name.c_str());
-			}
-		}
+// Shares the incumbent of this solve with the race, and stops the race when the
+// bound of this solve cannot improve on the best incumbent of all racers
+class RaceCallbackI : public IloCplex::MIPInfoCallbackI {
+	MILPrace *race;
+	double epgap;
 
-		// Number of missed jobs after completion of next effective job of producer task (M2 jobs)
-		IntVarMatrix MISSAFTEREFFECTIVE(env, NUMBER_OF_TASKS_IN_CHAIN);
-		for (int t = 0; t < NUMBER_OF_TASKS_IN_CHAIN; t++) {
-			MISSAFTEREFFECTIVE[t] = IloIntVarArray(env, NUMBER_OF_PATHS);
-			for (unsigned int l = 0; l < NUMBER_OF_PATHS; l++) {
-				string name = "nMISSV" + convert_to_string(t) + convert_to_string(l);
-				MISSAFTEREFFECTIVE[t][l] = IloIntVar(env, 0.0, UINT16_MAX, name.c_str());
-			}
-		}
+public:
+	RaceCallbackI(IloEnv env, MILPrace *race, double epgap)
+		: IloCplex::MIPInfoCallbackI(env), race(race), epgap(epgap) {}
 
-		// Auxiliary variable: there is at least one V job of task t between the jobs of paths p and p+1
-		IntVarMatrix boolVOIDJOBS(env, NUMBER_OF_TASKS_IN_CHAIN);
-		for (int t = 0; t < NUMBER_OF_TASKS_IN_CHAIN; t++) {
-			boolVOIDJOBS[t] = IloIntVarArray(env, NUMBER_OF_PATHS - 1);
-			for (unsigned int l = 0; l < NUMBER_OF_PATHS - 1; l++) {
-				string name = "boolHV" + convert_to_string(t) + convert_to_string(l);
-				boolVOIDJOBS[t][l] = IloIntVar(env, 0.0, 1.0, name.c_str());
-			}
-		}
+	IloCplex::CallbackI* duplicateCallback() const {
+		return new (getEnv()) RaceCallbackI(*this);
+	}
 
-		// Auxiliary variable: length of subsequence between two blocks of misses is <= k
-		IntVar3Matrix boolLENGTHK(env, NUMBER_OF_TASKS_IN_CHAIN);
-		for (int t = 0; t < NUMBER_OF_TASKS_IN_CHAIN; t++) {
-			boolLENGTHK[t] = IntVarMatrix(env, 2 * NUMBER_OF_PATHS);
-			for (unsigned int l = 0; l < 2 * NUMBER_OF_PATHS; l++) {
-				boolLENGTHK[t][l] = IloIntVarArray(env, 2 * NUMBER_OF_PATHS);
-				for (unsigned int p = 0; p < 2 * NUMBER_OF_PATHS; p++) {
-					string name = "boolLEN" + convert_to_string(t) + convert_to_string(l) + convert_to_string(p);
-					boolLENGTHK[t][l][p] = IloIntVar(env, 0.0, 1.0, name.c_str());
-				}
-			}
+	void main() {
+		if (race->finished()) {
+			abort();
+			return;
 		}
 
+		if (hasIncumbent())
+			race->publish(getIncumbentObjValue());
 
-#ifdef __DEBUG_MILP__
-		cout << "DONE!" << endl;
-		//-----------------------------------------------------------------------------------------------------------------------------------------  
-		cout << "[MILP] Starting constraints" << endl;
-#endif
+		double best;
+		if (race->best_incumbent(best) && getBestObjValue() - best <= epgap * fabs(best) + TOL)
+			race->finish();
+	}
+};
 
 
-		//----------------------------------------------------------------------------
-		// CONSTRAINT 1
-		// Constraining variables for head task of the chain		
-		// Offset of head task is 0
-		model.add(OFFS[0] == 0);
-		// First effective job of head task has index 0
-		model.add(EFFECTIVEJOB[0][0] == 0);
+MILPworkspace* MILP_create_workspace()
+{
+	return new MILPworkspace();
+}
 
 
-		//----------------------------------------------------------------------------
-		// CONSTRAINT 2
-		// Encoded in definition of OFFS
+void MILP_free_workspace(MILPworkspace *ws)
+{
+	delete ws;
+}
 
 
-		//----------------------------------------------------------------------------
-		// CONSTRAINT 3
-		// Head task cannot have redundant jobs
-		for (int p = 0; p < NUMBER_OF_PATHS - 1; p++) {
-			model.add(REDUNDHITS[0][p] == 0);
-		}
-		// Head task cannot have "misses after effective job of producer task" (it has no producer!)
-		for (int p = 0; p < NUMBER_OF_PATHS; p++) {
-			model.add(MISSAFTEREFFECTIVE[0][p] == 0);
-		}
-		// Tail task cannot have void jobs
-		for (int p = 0; p < NUMBER_OF_PATHS - 1; p++) {
-			model.add(VOIDHITS[NUMBER_OF_TASKS_IN_CHAIN - 1][p] == 0);
-			model.add(boolVOIDJOBS[NUMBER_OF_TASKS_IN_CHAIN - 1][p] == 0);
-		}
-
+MILPresult MILP_WH_K(const vector<Task> &taskchain, const vector<WHconstr> &setofmk, OptTarget mytarget,
+	const MILPoptions &opts)
+{
+	return MILP_WH_K(taskchain, setofmk, mytarget, opts, NULL);
+}
 
-		//----------------------------------------------------------------------------
-		// CONSTRAINT 4
-		// Checking if there exist void hits at level of task t
-		// Note that task tail cannot have void hits
-		for (int t = 0; t < NUMBER_OF_TASKS_IN_CHAIN - 1; t++) {
-			for (int p = 0; p < NUMBER_OF_PATHS - 1; p++) {
-
-				int Tt = taskchain.at(t).period;
-				int Dt = taskchain.at(t).deadline;
-
-				model.add(VOIDHITS[t][p] <= boolVOIDJOBS[t][p] * BIGM);
-				model.add(VOIDHITS[t][p] >= boolVOIDJOBS[t][p]);
-			}
-		}
 
+MILPresult MILP_WH_K(const vector<Task> &taskchain, const vector<WHconstr> &inputmk, OptTarget mytarget,
+	const MILPoptions &inputopts, MILPworkspace *ws)
+{
+	auto start_time = chrono::steady_clock::now();
 
-		//----------------------------------------------------------------------------
-		// CONSTRAINT 5
-		// Effective job of i-th task of the chain must start before the
-		// next hit job of (i-1)th task of the chain completes with a different output 
-		for (int t = 1; t < NUMBER_OF_TASKS_IN_CHAIN; t++) {
-			for (int p = 0; p < NUMBER_OF_PATHS - 1; p++) {
-
-				int Tt = taskchain.at(t).period;
-				int Dt = taskchain.at(t).deadline;
-
-				int Tt1 = taskchain.at(t - 1).period;
-				int Dt1 = taskchain.at(t - 1).deadline;
-
-				// The activation of EFFECTIVEJOB_tp occurs after (or at) the completion of EFFECTIVEJOB_(t-1)p
-				model.add(OFFS[t] + Tt * EFFECTIVEJOB[t][p] >= 
-					OFFS[t - 1] + Tt1 * EFFECTIVEJOB[t - 1][p] + Dt1);
-
-				// The activation of EFFECTIVEJOB_tp occurs before the completion of EFFECTIVEJOB_(t-1)(p+1)
-				model.add(OFFS[t] + Tt * EFFECTIVEJOB[t][p] <=
-					OFFS[t - 1] + Tt1 * EFFECTIVEJOB[t - 1][p + 1] + Dt1 - TOL);
-			}
-		}
+	//-----------------------------------------------------------------------------
+	// PROBLEM PARAMETERS
+	//-----------------------------------------------------------------------------
 
+	// Number of tasks in a chain
+	const int NUMBER_OF_TASKS_IN_CHAIN = taskchain.size();
 
-		//----------------------------------------------------------------------------
-		// CONSTRAINT 6
-		// Between the end of the effective job of task t-1 of path p, and the beginning of the 
-		// effective job of task t of the same path p, task t-1 cannot have INCOMPLHITS
-		for (int t = 1; t < NUMBER_OF_TASKS_IN_CHAIN; t++) {
-			for (int p = 0; p < NUMBER_OF_PATHS - 1; p++) {
-
-				int Tt = taskchain.at(t).period;
-				int Dt = taskchain.at(t).deadline;
-
-				int Tt1 = taskchain.at(t - 1).period;
-				int Dt1 = taskchain.at(t - 1).deadline;
-
-				model.add(OFFS[t - 1] + (EFFECTIVEJOB[t - 1][p] + REDUNDHITS[t - 1][p]
-					+ MISSWNEWINPUT[t - 1][p] + 1) * Tt1 + Dt1 - TOL >=
-					OFFS[t] + EFFECTIVEJOB[t][p] * Tt - (1 - boolVOIDJOBS[t - 1][p]) * BIGM);
-			}
+	// Solver settings tuned for this class of chains, if profiles are given
+	const MILPoptions opts = select_profile(inputopts, taskchain, inputmk);
+
+	// Malformed or inconsistent inputs never reach the solver
+	if (opts.validate) {
+		MILPresult invalid;
+		if (!validate_chain(taskchain, inputmk, invalid.message, invalid.conflict_tasks)) {
+			invalid.status = MILP_INVALID;
+			if (opts.verbose)
+				cerr << invalid.message;
+			auto end_time = chrono::steady_clock::now();
+			invalid.runtime = chrono::duration<double>(end_time - start_time).count();
+			return invalid;
 		}
+	}
 
-
-		//----------------------------------------------------------------------------
-		// CONSTRAINT 7
-		// A task t may have redundant hits after a effective job, until task t-1 has produced a new output
-		// Head task has no redundant hits (already defined above)
-		for (int t = 1; t < NUMBER_OF_TASKS_IN_CHAIN; t++) {
-			for (int p = 0; p < NUMBER_OF_PATHS - 1; p++) {
-
-				int Tt = taskchain.at(t).period;
-				int Dt = taskchain.at(t).deadline;
-
-				int Tt1 = taskchain.at(t - 1).period;
-				int Dt1 = taskchain.at(t - 1).deadline;
-
-				// The activation of the last redundant hit must occur before the end of the first job of
-				// producer task that works on new data and that successfully completes
-				model.add(OFFS[t] + Tt * (EFFECTIVEJOB[t][p] + REDUNDHITS[t][p]) <=
-					OFFS[t - 1] + Tt1 * (EFFECTIVEJOB[t - 1][p] + REDUNDHITS[t - 1][p]
-						+ MISSWNEWINPUT[t - 1][p] + 1)
-					+ Dt1 - TOL + (1 - boolVOIDJOBS[t - 1][p]) * BIGM);
-
-				model.add(OFFS[t] + Tt * (EFFECTIVEJOB[t][p] + REDUNDHITS[t][p]) <=
-					OFFS[t - 1] + Tt1 * (EFFECTIVEJOB[t - 1][p] + REDUNDHITS[t - 1][p]
-						+ MISSWNEWINPUT[t - 1][p] + MISSAFTEREFFECTIVE[t - 1][p + 1] + 1)
-					+ Dt1 - TOL + boolVOIDJOBS[t - 1][p] * BIGM);
-			}
+	// Weakly-hard constraints without redundant (m,k) pairs
+	const vector<WHconstr> setofmk = opts.normalize_wh ? normalize_constraints(inputmk) : inputmk;
+
+	// Hard tasks never miss: their miss counters are fixed to zero and the (m,k) machinery is dropped
+	vector<bool> hard(NUMBER_OF_TASKS_IN_CHAIN, false);
+	if (opts.hard_presolve)
+		hard = hard_tasks(setofmk);
+
+	// Harmonic links (period of task t divides period of task t-1) have a constant phase between
+	// the completion of the producer and the next activation of the consumer
+	vector<bool> harmonic(NUMBER_OF_TASKS_IN_CHAIN, false);
+	if (opts.harmonic_links)
+		harmonic = harmonic_links(taskchain);
+
+	// Bulk construction, without Concert
+	if (opts.bulk_build) {
+		MILPresult MILP_out = MILP_WH_K_bulk(taskchain, setofmk, hard, harmonic, mytarget, opts);
+
+		// The conflict refiner needs the rows grouped per task: proven infeasibility is handed to the
+		// Concert build, which solves again and refines (infeasibility is usually proven at the root)
+		if (MILP_out.status == MILP_INFEASIBLE && opts.refine_conflict) {
+			MILPoptions refine_opts = opts;
+			refine_opts.bulk_build = false;
+			refine_opts.profiles = nullptr;
+			refine_opts.validate = false;
+			refine_opts.race = nullptr;
+			refine_opts.export_model.clear();
+			refine_opts.results_file.clear();
+			MILPresult refined = MILP_WH_K(taskchain, inputmk, mytarget, refine_opts, ws);
+			if (refined.status == MILP_INFEASIBLE)
+				MILP_out.conflict_tasks = refined.conflict_tasks;
 		}
 
+		if (!MILP_out.tasks.empty() && !opts.results_file.empty())
+			write_results_file(opts.results_file, taskchain, MILP_out);
+		if (opts.verbose && !MILP_out.message.empty())
+			cerr << MILP_out.message << endl;
 
-		//----------------------------------------------------------------------------
-		// CONSTRAINT 8
-		// Between the end of the effective job of task t-1 of path p, and the beginning of the 
-		// effective job of task t of the same path p, task t may miss MISSAFTEREFFECTIVE jobs
-		for (int t = 1; t < NUMBER_OF_TASKS_IN_CHAIN; t++) {
-			for (int p = 0; p < NUMBER_OF_PATHS; p++) {
-
-				int Tt = taskchain.at(t).period;
-				int Dt = taskchain.at(t).deadline;
-
-				int Tt1 = taskchain.at(t - 1).period;
-				int Dt1 = taskchain.at(t - 1).deadline;
-
-				// floor function of the number of instances of task t between the end of 
-				// EFFECTIVEJOB_(t-1)p and the activation of EFFECTIVEJOB_tp
-				model.add(MISSAFTEREFFECTIVE[t][p] >=
-					(OFFS[t] + EFFECTIVEJOB[t][p] * Tt -
-					(OFFS[t - 1] + EFFECTIVEJOB[t - 1][p] * Tt1 + Dt1)) / Tt - 1 + TOL);
-
-				model.add(MISSAFTEREFFECTIVE[t][p] <=
-					(OFFS[t] + EFFECTIVEJOB[t][p] * Tt -
-					(OFFS[t - 1] + EFFECTIVEJOB[t - 1][p] * Tt1 + Dt1)) / Tt);
-			}
-		}
+		auto end_time = chrono::steady_clock::now();
+		MILP_out.runtime = chrono::duration<double>(end_time - start_time).count();
+		return MILP_out;
+	}
 
+	//-----------------------------------------------------------------------------
+	// START MILP DESIGN
+	//-----------------------------------------------------------------------------
 
-		//----------------------------------------------------------------------------
-		// CONSTRAINT 9
-		// The index of the effective job of path p+1 is equal to the index of the effective job of path p
-		// plus REDUNDHITS + MISSWNEWINPUT + VOIDHITS + MISSAFTEREFFECTIVE + 1
-		for (int t = 0; t < NUMBER_OF_TASKS_IN_CHAIN; t++) {
-			for (int p = 0; p < NUMBER_OF_PATHS - 1; p++) {
-
-				model.add(EFFECTIVEJOB[t][p + 1] ==
-					EFFECTIVEJOB[t][p] + REDUNDHITS[t][p] + MISSWNEWINPUT[t][p]
-					+ VOIDHITS[t][p] + MISSAFTEREFFECTIVE[t][p + 1] + 1);
-			}
-		}
+	// Solver environment: private to this call, or the warm one of the workspace
+	IloEnv env = (ws != NULL) ? ws->env : IloEnv();
 
-		// Index of effective job of path p+1 is greater than index of effective job of path p
-		for (int t = 0; t < NUMBER_OF_TASKS_IN_CHAIN; t++) {
-			for (int p = 0; p < NUMBER_OF_PATHS - 1; p++) {
-				model.add(EFFECTIVEJOB[t][p + 1] >= 1 + EFFECTIVEJOB[t][p]);
-			}
-		}
+	// MILP output
+	MILPresult MILP_out;
 
+	// Keep solver output off stdout unless asked for
+	env.setOut(opts.verbose ? cout : env.getNullStream());
+	env.setWarning(opts.verbose ? cerr : env.getNullStream());
 
-		//----------------------------------------------------------------------------
-		// CONSTRAINT 10
-		// A task cannot miss more than m_consec misses
-		for (int t = 0; t < NUMBER_OF_TASKS_IN_CHAIN; t++) {
-			for (int p = 0; p < NUMBER_OF_PATHS - 1; p++) {
-				model.add(MISSWNEWINPUT[t][p] <= setofmk.at(t).mconsec);
-				model.add(MISSAFTEREFFECTIVE[t][p] <= setofmk.at(t).mconsec);
-			}
-			model.add(MISSAFTEREFFECTIVE[t][NUMBER_OF_PATHS - 1] <= setofmk.at(t).mconsec);
-		}
+	IloModel model(env);
+	const ChainModelInput in = { taskchain, setofmk, hard, harmonic, opts };
+	ChainVars vars;
+	TaskRows taskrows(model, NUMBER_OF_TASKS_IN_CHAIN);
 
+	// Registration in the race, if any
+	int race_id = -1;
 
+#ifdef __DEBUG_MILP__
+	if (opts.verbose)
+		cout << "[MILP] Setting up variables...";
+#endif
+	try
+	{
 		//----------------------------------------------------------------------------
-		// CONSTRAINT 11
-		// If there are no void jobs, MISSWNEWINPUT and MISSAFTEREFFECTIVE occur side by side
-		// thus mconsec must be enforced for the whole sequence
-		for (int t = 0; t < NUMBER_OF_TASKS_IN_CHAIN; t++) {
-			for (int p = 0; p < NUMBER_OF_PATHS - 1; p++) {
-
-				int Tt = taskchain.at(t).period;
-				int Dt = taskchain.at(t).deadline;
-
-				model.add(MISSWNEWINPUT[t][p] + MISSAFTEREFFECTIVE[t][p + 1] <=
-					setofmk.at(t).mconsec + boolVOIDJOBS[t][p] * BIGM);
-			}
-		}
-		
-
+		// VARIABLES DEFINITION (see add_task_vars)
 		//----------------------------------------------------------------------------
-		// CONSTRAINT 12 & CONSTRAINT 13
-		// Miss and hit patterns must satisfy also the (m,k) constraints
-		for (int t = 0; t < NUMBER_OF_TASKS_IN_CHAIN; t++) {
-
-			// Checking sequences starting from MISSAFTEREFFECTIVE
-			for (int s = 0; s < NUMBER_OF_PATHS - 1; s++) {
-
-				IloExpr LENGTHSEQ(env);
-				IloExpr NUMMISSES(env);
-
-				LENGTHSEQ += MISSAFTEREFFECTIVE[t][s];
-				NUMMISSES += MISSAFTEREFFECTIVE[t][s];
-
-				for (int p = s; p < NUMBER_OF_PATHS - 1; p++) {
-
-					// Check until MISSNEWINPUT
-					LENGTHSEQ += 1 + REDUNDHITS[t][p] + MISSWNEWINPUT[t][p];
-					NUMMISSES += MISSWNEWINPUT[t][p];
 
-					for (int i = 0; i < setofmk.at(t).mk.size(); i++) {
+		for (int t = 0; t < NUMBER_OF_TASKS_IN_CHAIN; t++)
+			add_task_vars(model, in, vars, t);
+		for (int t = 1; t < NUMBER_OF_TASKS_IN_CHAIN; t++)
+			add_link_vars(model, in, vars, t);
 
-						int m = setofmk.at(t).mk.at(i).m;
-						int k = setofmk.at(t).mk.at(i).k;
+		// Names, for exported models
+		if (opts.var_names || !opts.export_model.empty())
+			name_vars(in, vars);
 
-						model.add(LENGTHSEQ <= k + (1 - boolLENGTHK[t][2 * s][2 * p]) * BIGM);
-						model.add(LENGTHSEQ >= k + 1 - boolLENGTHK[t][2 * s][2 * p] * BIGM);
 
-						// Adding necessary and sufficient constraints to check (m,k)
-						model.add(NUMMISSES <= m + (1 - boolLENGTHK[t][2 * s][2 * p]) * BIGM);
-						model.add(LENGTHSEQ - NUMMISSES >= k - m - boolLENGTHK[t][2 * s][2 * p] * BIGM);
-					}
-
-					// Continue checking until MISSAFTEREFFECTIVE
-					LENGTHSEQ += VOIDHITS[t][p] + MISSAFTEREFFECTIVE[t][p + 1];
-					NUMMISSES += MISSAFTEREFFECTIVE[t][p + 1];
-
-					for (int i = 0; i < setofmk.at(t).mk.size(); i++) {
-
-						int m = setofmk.at(t).mk.at(i).m;
-						int k = setofmk.at(t).mk.at(i).k;
-
-						model.add(LENGTHSEQ <= k + (1 - boolLENGTHK[t][2 * s][2 * p + 1]) * BIGM);
-						model.add(LENGTHSEQ >= k + 1 - boolLENGTHK[t][2 * s][2 * p + 1] * BIGM);
-
-						// Adding necessary and sufficient constraints to check (m,k)
-						model.add(NUMMISSES <= m + (1 - boolLENGTHK[t][2 * s][2 * p + 1]) * BIGM);
-						model.add(LENGTHSEQ - NUMMISSES >= k - m - boolLENGTHK[t][2 * s][2 * p + 1] * BIGM);
-					}
-				}
-			}
-
-			// Checking sequences starting from MISSNEWINPUT
-			for (int s = 0; s < NUMBER_OF_PATHS - 1; s++) {
-
-				IloExpr LENGTHSEQ(env);
-				IloExpr NUMMISSES(env);
-
-				LENGTHSEQ += MISSWNEWINPUT[t][s];
-				NUMMISSES += MISSWNEWINPUT[t][s];
-
-				for (int p = s; p < NUMBER_OF_PATHS - 1; p++) {
-
-					// Check until MISSAFTEREFFECTIVE
-					LENGTHSEQ += VOIDHITS[t][p] + MISSAFTEREFFECTIVE[t][p + 1];
-					NUMMISSES += MISSAFTEREFFECTIVE[t][p + 1];
-
-					for (int i = 0; i < setofmk.at(t).mk.size(); i++) {
-
-						int m = setofmk.at(t).mk.at(i).m;
-						int k = setofmk.at(t).mk.at(i).k;
-
-						model.add(LENGTHSEQ <= k + (1 - boolLENGTHK[t][2 * s + 1][2 * p]) * BIGM);
-						model.add(LENGTHSEQ >= k + 1 - boolLENGTHK[t][2 * s + 1][2 * p] * BIGM);
-
-						// Adding necessary and sufficient constraints to check (m,k)
-						model.add(NUMMISSES <= m + (1 - boolLENGTHK[t][2 * s + 1][2 * p]) * BIGM);
-						model.add(LENGTHSEQ - NUMMISSES >= k - m - boolLENGTHK[t][2 * s + 1][2 * p] * BIGM);
-					}
-					
-					if (p < NUMBER_OF_PATHS - 2) {
-						// Check until MISSNEWINPUT
-						LENGTHSEQ += 1 + REDUNDHITS[t][p+1] + MISSWNEWINPUT[t][p+1];
-						NUMMISSES += MISSWNEWINPUT[t][p+1];
+#ifdef __DEBUG_MILP__
+		if (opts.verbose) {
+			cout << "DONE!" << endl;
+			//-----------------------------------------------------------------------------------------------------------------------------------------  
+			cout << "[MILP] Starting constraints" << endl;
+		}
+#endif
 
-						for (int i = 0; i < setofmk.at(t).mk.size(); i++) {
 
-							int m = setofmk.at(t).mk.at(i).m;
-							int k = setofmk.at(t).mk.at(i).k;
+		//----------------------------------------------------------------------------
+		// CONSTRAINTS 1-13 AND VALID INEQUALITIES (see add_task_rows), task by task
+		//----------------------------------------------------------------------------
 
-							model.add(LENGTHSEQ <= k + (1 - boolLENGTHK[t][2 * s + 1][2 * p + 1]) * BIGM);
-							model.add(LENGTHSEQ >= k + 1 - boolLENGTHK[t][2 * s + 1][2 * p + 1] * BIGM);
+		for (int t = 0; t < NUMBER_OF_TASKS_IN_CHAIN; t++)
+			add_task_rows(in, vars, t, taskrows);
 
-							// Adding necessary and sufficient constraints to check (m,k)
-							model.add(NUMMISSES <= m + (1 - boolLENGTHK[t][2 * s + 1][2 * p + 1]) * BIGM);
-							model.add(LENGTHSEQ - NUMMISSES >= k - m - boolLENGTHK[t][2 * s + 1][2 * p + 1] * BIGM);
-						}
-					}					
-				}
-			}
-		}
+		if (opts.valid_ineq & VALID_EJ_BOUNDS)
+			set_effective_job_bounds(in, vars);
 
 
 #ifdef __DEBUG_MILP__
-		cout << "Constraints DONE." << endl;
-		//-----------------------------------------------------------------------------------------------------------------------------------------  
-		cout << "[MILP] Objective Funtion:" << endl;
+		if (opts.verbose) {
+			cout << "Constraints DONE." << endl;
+			//-----------------------------------------------------------------------------------------------------------------------------------------  
+			cout << "[MILP] Objective Funtion:" << endl;
+		}
 #endif
 
 		//-----------------------------------------------------------------------------
 		// OBJECTIVE FUNCTION
 		//-----------------------------------------------------------------------------
 
-		int tailtask_id = NUMBER_OF_TASKS_IN_CHAIN - 1;
-		int Tt = taskchain.at(tailtask_id).period;
-		int Dt = taskchain.at(tailtask_id).deadline;
-
 		IloNumVar OBJ(env, -INT_MAX, INT_MAX);
 
-		switch (mytarget) {
-
-		case MAXIMIZE_LATENCY: // Maximize end-to-end latency of effective path
-			model.add(OBJ <= OFFS[tailtask_id] + EFFECTIVEJOB[tailtask_id][0] * Tt + Dt);
-			break;
-
-		case MAXIMIZE_DATAAGE: // Maximize data age
-			model.add(OBJ <= OFFS[tailtask_id] + EFFECTIVEJOB[tailtask_id][1] * Tt);
-			break;
-
-		case MAXIMIZE_UPDATE_INT: // Maximize update interval
-			model.add(OBJ <= (EFFECTIVEJOB[tailtask_id][1] - EFFECTIVEJOB[tailtask_id][0]) * Tt);
-			break;
-
-		case MINIMIZE_UPDATE_INT: // Minimize update interval
-			model.add(OBJ <= -(EFFECTIVEJOB[tailtask_id][1] - EFFECTIVEJOB[tailtask_id][0]) * Tt);
-			break;
-
-		default:
-			env.error() << "Unknown optimization target" << endl;
+		IloConstraint objrow;
+		if (!objective_row(in, vars, mytarget, OBJ, objrow)) {
+			MILP_out.message = "Unknown optimization target";
 			throw(-1);
 		}
-
+		model.add(objrow);
 		model.add(IloMaximize(env, OBJ));
 
 
 #ifdef __DEBUG_MILP__
-		cout << "DONE." << endl;
+		if (opts.verbose)
+			cout << "DONE." << endl;
 		//-----------------------------------------------------------------------------------------------------------------------------------------  
 #endif
 
@@ -497,86 +283,95 @@ double MILP_WH_K(vector<Task> &taskchain, vector<WHconstr> &setofmk, OptTarget m
 		// SOLVER PARAMETERS
 		//-----------------------------------------------------------------------------
 
-		IloCplex cplex(model);
-		cplex.exportModel("qcpex1.lp");
+		IloCplex cplex = (ws != NULL) ? ws->cplex : IloCplex(env);
+		if (ws != NULL)
+			cplex.setDefaults();
+		cplex.extract(model);
+		cplex.setOut(opts.verbose ? cout : env.getNullStream());
+		if (!opts.export_model.empty())
+			cplex.exportModel(opts.export_model.c_str());
 		// Optimize the problem and obtain solution.
 
-		// Set minimum GAP to 1%
-		cplex.setParam(IloCplex::EpGap, 1e-2);
+		// Set minimum GAP (1% by default)
+		cplex.setParam(IloCplex::EpGap, opts.epgap);
 
 		// Stop at the first feasibile solution
 		//cplex.setParam(IloCplex::IntSolLim, 1);
 
-		// Stop after reaching the time limit 2 hours
-		cplex.setParam(IloCplex::TiLim, 7200);
+		// Stop after reaching the time limit (2 hours by default)
+		cplex.setParam(IloCplex::TiLim, opts.timelimit);
 
 		// Set maximum number of threads 
-		cplex.setParam(IloCplex::Threads, 4);
+		cplex.setParam(IloCplex::Threads, opts.threads);
+
+		// Search strategy
+		cplex.setParam(IloCplex::MIPEmphasis, opts.mipemphasis);
+		cplex.setParam(IloCplex::HeurFreq, opts.heurfreq);
+		if (opts.random_seed >= 0)
+			cplex.setParam(IloCplex::RandomSeed, opts.random_seed);
+
+		// Cut aggressiveness and branching priorities
+		set_search_params(cplex, in, vars);
+
+		// Valid inequalities kept in the cut pool: CPLEX adds them only when the relaxation violates them
+		IloConstraintArray validcuts = taskrows.all_cuts();
+		if (validcuts.getSize() > 0)
+			cplex.addUserCuts(validcuts);
+
+		// Racing: interruptible from the other racers, sharing incumbents
+		IloCplex::Callback race_cb;
+		if (opts.race != NULL) {
+			IloCplex::Aborter aborter(env);
+			cplex.use(aborter);
+			race_id = opts.race->register_abort([aborter]() mutable { aborter.abort(); });
+			race_cb = cplex.use(IloCplex::Callback(new (env) RaceCallbackI(env, opts.race, opts.epgap)));
+		}
+
+		bool solved = cplex.solve();
+
+		if (opts.race != NULL) {
+			opts.race->unregister_abort(race_id);
+			race_id = -1;
+			cplex.remove(race_cb);
+			cplex.removeAborter();
+		}
+
+		MILP_out.nodes = cplex.getNnodes();
 
-		if (!cplex.solve()) {
+		// User cuts belong neither to the model nor to the next analysis of the workspace
+		if (validcuts.getSize() > 0)
+			cplex.clearUserCuts();
+		validcuts.end();
+
+		if (!solved) {
 			env.error() << "Failed to optimize LP" << endl;
 			env.out() << "Solution status = " << cplex.getStatus() << endl;
+
+			MILP_out.status = failed_status(cplex);
+
+			if (MILP_out.status == MILP_INFEASIBLE && opts.refine_conflict)
+				refine_conflict(cplex, taskrows, MILP_out);
 			throw(-1);
 		}
 
 		env.out() << "Solution status = " << cplex.getStatus() << endl;
 		env.out() << "Solution value  = " << cplex.getObjValue() << endl;
 
+		// Proved optimal: the other racers have nothing left to do
+		if (opts.race != NULL && cplex.getStatus() == IloAlgorithm::Optimal)
+			opts.race->finish();
+
 
 		//-----------------------------------------------------------------------------
 		// SAVE EVERYTHING
 		//-----------------------------------------------------------------------------
 
-		// Save objective function output
-		if (mytarget == MINIMIZE_UPDATE_INT)
-			MILP_out = cplex.getValue(-OBJ);
-		else
-			MILP_out = cplex.getValue(OBJ);
+		MILP_out.status = (cplex.getStatus() == IloAlgorithm::Optimal) ? MILP_OPTIMAL : MILP_FEASIBLE;
 
-		ofstream results;
-		results.open("results.txt");
+		save_solution(cplex, in, vars, mytarget, OBJ, MILP_out);
 
-		results << "Task" << "\t" << "Period" << "\t" << "Offs";
-
-		for (int p = 1; p < NUMBER_OF_PATHS; p++) {
-			results << "\t" << "VMiss" << p;
-			results << "\t" << "Vhit" << p; 
-			results << "\t" << "RedHs" << p;
-			results << "\t" << "Miss" << p;
-			results << "\t" << "IncHs" << p;
-			
-		}
-		results << "\t" << "VMiss" << NUMBER_OF_PATHS;
-		results << "\t" << "Vhit" << NUMBER_OF_PATHS;
-		results << endl;
-
-		for (int t = 0; t < NUMBER_OF_TASKS_IN_CHAIN; t++) {
-
-			results << taskchain.at(t).id << "\t" << taskchain.at(t).period << "\t";
-			results << (cplex.getValue(OFFS[t]));
-			
-			for (int p = 0; p < NUMBER_OF_PATHS - 1; p++) {
-
-				int Mv = round(cplex.getValue(MISSAFTEREFFECTIVE[t][p]));
-				results << "\t" << Mv;
-				int V = round(cplex.getValue(EFFECTIVEJOB[t][p]));
-				results << "\t" << V ;
-				int Hr = round(cplex.getValue(REDUNDHITS[t][p]));
-				results << "\t" << Hr;
-				int NM = round(cplex.getValue(MISSWNEWINPUT[t][p]));
-				results << "\t" << NM;
-				int Hv = round(cplex.getValue(VOIDHITS[t][p]));
-				results << "\t" << Hv;
-
-			}
-			int Mv = round(cplex.getValue(MISSAFTEREFFECTIVE[t][NUMBER_OF_PATHS - 1]));
-			results << "\t" << Mv;
-			int V = round(cplex.getValue(EFFECTIVEJOB[t][NUMBER_OF_PATHS - 1]));
-			results << "\t"  << V;
-
-			results << endl;
-		}
-		results.close();
+		if (!opts.results_file.empty())
+			write_results_file(opts.results_file, taskchain, MILP_out);
 
 	} // End of try
 
@@ -586,15 +381,53 @@ double MILP_WH_K(vector<Task> &taskchain, vector<WHconstr> &setofmk, OptTarget m
 
 	catch (IloAlgorithm::CannotExtractException &e) {
 		IloExtractableArray &failed = e.getExtractables();
-		std::cerr << "Failed to extract:" << std::endl;
+		std::stringstream msg;
+		msg << "Failed to extract:";
 		for (IloInt i = 0; i < failed.getSize(); ++i)
-			std::cerr << "\t" << failed[i] << std::endl;
+			msg << " " << failed[i];
+		MILP_out.status = MILP_ERROR;
+		MILP_out.message = msg.str();
 	}
 	catch (IloException& e) {
-		cerr << "Concert exception caught: " << e << endl;
+		std::stringstream msg;
+		msg << "Concert exception caught: " << e;
+		MILP_out.status = MILP_ERROR;
+		MILP_out.message = msg.str();
 	}
+	catch (int) {
+		// Solver did not return a solution, status already set
+		if (MILP_out.message.empty())
+			MILP_out.message = "No solution available";
+	}
+
+	if (opts.verbose && !MILP_out.message.empty())
+		cerr << MILP_out.message << endl;
 
-	env.end();
+	// Nobody may interrupt this solve once its environment is gone
+	if (race_id >= 0)
+		opts.race->unregister_abort(race_id);
+
+	taskrows.end();
+
+	// The groups of a conflict refinement are not owned by the model: recycle the environment
+	if (ws == NULL)
+		env.end();
+	else
+		ws->release(model, MILP_out.status == MILP_ERROR || !MILP_out.conflict_tasks.empty());
+
+	auto end_time = chrono::steady_clock::now();
+	MILP_out.runtime = chrono::duration<double>(end_time - start_time).count();
 
 	return MILP_out;
+}
+
+
+double MILP_WH_K(vector<Task> &taskchain, vector<WHconstr> &setofmk, OptTarget mytarget)
+{
+	MILPoptions opts;
+	opts.verbose = true;
+	opts.export_model = "qcpex1.lp";
+	opts.results_file = "results.txt";
+
+	return MILP_WH_K(taskchain, setofmk, mytarget, opts).objective;
 } 
@@ -0,0 +1,691 @@
+#include <ilcplex/cplex.h>
+#include <string>
+#include <vector>
+#include <climits>
+#include <cmath>
+#include <sstream>
+
+#include "milp_bulk.h"
+#include "milp_race.h"
+#include "milp_presolve.h"
+
+#define TOL 0.001
+#define TOL_OFFS 0.001
+
+using namespace std;
+
+
+//-----------------------------------------------------------------------------
+// CSR ARRAYS
+//-----------------------------------------------------------------------------
+
+// Linear expression kept aside, for the running sums of constraints 12 and 13
+struct LinExpr {
+	vector<int> ind;
+	vector<double> val;
+	double constant = 0;
+
+	void add(int col, double coef) { ind.push_back(col); val.push_back(coef); }
+};
+
+
+class CSRmodel {
+public:
+	vector<double> obj, lb, ub;
+	vector<char> ctype;
+	vector<string> colname;
+
+	vector<int> rmatbeg;
+	vector<int> rmatind;
+	vector<double> rmatval;
+	vector<double> rhs;
+	vector<char> sense;
+
+	CSRmodel(int num_cols, int num_rows, int num_nz, bool names) : names(names) {
+		obj.reserve(num_cols); lb.reserve(num_cols); ub.reserve(num_cols); ctype.reserve(num_cols);
+		if (names)
+			colname.reserve(num_cols);
+		rmatbeg.reserve(num_rows + 1); rhs.reserve(num_rows); sense.reserve(num_rows);
+		rmatind.reserve(num_nz); rmatval.reserve(num_nz);
+		rmatbeg.push_back(0);
+	}
+
+	int col(double lo, double up, char type, const string &name) {
+		obj.push_back(0);
+		lb.push_back(lo);
+		ub.push_back(up);
+		ctype.push_back(type);
+		if (names)
+			colname.push_back(name);
+		return obj.size() - 1;
+	}
+
+	bool named() const { return names; }
+
+	// Terms of the row being built, appended in place
+	void term(int col, double coef) {
+		rmatind.push_back(col);
+		rmatval.push_back(coef);
+	}
+
+	void terms(const LinExpr &e, double scale) {
+		for (int i = 0; i < e.ind.size(); i++)
+			term(e.ind[i], scale * e.val[i]);
+	}
+
+	// Close the row: terms on the same column are merged, zeros dropped
+	void row(char s, double r) {
+		int beg = rmatbeg.back();
+		int end = beg;
+		for (int i = beg; i < rmatind.size(); i++) {
+			int j = beg;
+			while (j < end && rmatind[j] != rmatind[i])
+				j++;
+			if (j < end) {
+				rmatval[j] += rmatval[i];
+			}
+			else {
+				rmatind[end] = rmatind[i];
+				rmatval[end] = rmatval[i];
+				end++;
+			}
+		}
+		int kept = beg;
+		for (int i = beg; i < end; i++) {
+			if (rmatval[i] != 0) {
+				rmatind[kept] = rmatind[i];
+				rmatval[kept] = rmatval[i];
+				kept++;
+			}
+		}
+		rmatind.resize(kept);
+		rmatval.resize(kept);
+
+		rmatbeg.push_back(kept);
+		sense.push_back(s);
+		rhs.push_back(r);
+	}
+
+	int num_rows() const { return sense.size(); }
+
+private:
+	bool names;
+};
+
+
+static string cpx_error(CPXCENVptr env, int code)
+{
+	char buffer[CPXMESSAGEBUFSIZE];
+	CPXCCHARptr msg = CPXgeterrorstring(env, code, buffer);
+	if (msg == NULL) {
+		stringstream s;
+		s << "CPLEX error " << code;
+		return s.str();
+	}
+	return string(buffer);
+}
+
+
+MILPresult MILP_WH_K_bulk(const vector<Task> &taskchain, const vector<WHconstr> &setofmk,
+	const vector<bool> &hard, const vector<bool> &harmonic, OptTarget mytarget, const MILPoptions &opts)
+{
+	const int NUMBER_OF_PATHS = 2;
+	const int NUMBER_OF_TASKS_IN_CHAIN = taskchain.size();
+	const int N = NUMBER_OF_TASKS_IN_CHAIN;
+	const int P = NUMBER_OF_PATHS;
+	const double BIGM = INT_MAX;
+
+	MILPresult MILP_out;
+
+	//-----------------------------------------------------------------------------
+	// COLUMNS
+	//-----------------------------------------------------------------------------
+
+	int num_mk = 0;
+	for (int t = 0; t < N; t++)
+		num_mk += hard.at(t) ? 0 : setofmk.at(t).mk.size();
+
+	const int est_cols = N * (6 * P + 4 * P * P) + 1;
+	const int est_rows = N * 20 * P + num_mk * 16 * P * P + 8;
+	CSRmodel csr(est_cols, est_rows, 12 * est_rows, opts.var_names || !opts.export_model.empty());
+
+	auto name = [&csr](const string &prefix, int a, int b = -1, int c = -1) {
+		if (!csr.named())
+			return string();
+		string s = prefix + to_string(a);
+		if (b >= 0) s += to_string(b);
+		if (c >= 0) s += to_string(c);
+		return s;
+	};
+
+	vector<int> OFFS(N), PHASE(N, -1);
+	vector<vector<int> > EFFECTIVEJOB(N), REDUNDHITS(N), MISSWNEWINPUT(N), VOIDHITS(N), MISSAFTEREFFECTIVE(N), boolVOIDJOBS(N);
+	vector<vector<vector<int> > > boolLENGTHK(N);
+
+	for (int t = 0; t < N; t++)
+		OFFS[t] = csr.col(0.0, taskchain.at(t).period - TOL_OFFS, 'C', name("OFFS", t));
+	for (int t = 0; t < N; t++) {
+		for (int l = 0; l < P; l++)
+			EFFECTIVEJOB[t].push_back(csr.col(0.0, UINT16_MAX, 'I', name("EID", t, l)));
+		for (int l = 0; l < P - 1; l++)
+			REDUNDHITS[t].push_back(csr.col(0.0, UINT16_MAX, 'I', name("nRED", t, l)));
+		for (int l = 0; l < P; l++)
+			MISSWNEWINPUT[t].push_back(csr.col(0.0, hard.at(t) ? 0.0 : UINT16_MAX, 'I', name("nMISSni", t, l)));
+		for (int l = 0; l < P - 1; l++)
+			VOIDHITS[t].push_back(csr.col(0.0, UINT16_MAX, 'I', name("nINC", t, l)));
+		for (int l = 0; l < P; l++)
+			MISSAFTEREFFECTIVE[t].push_back(csr.col(0.0, hard.at(t) ? 0.0 : UINT16_MAX, 'I', name("nMISSV", t, l)));
+		if (!hard.at(t)) {
+			for (int l = 0; l < P - 1; l++)
+				boolVOIDJOBS[t].push_back(csr.col(0.0, 1.0, 'B', name("boolHV", t, l)));
+			boolLENGTHK[t].resize(2 * P);
+			for (int l = 0; l < 2 * P; l++)
+				for (int p = 0; p < 2 * P; p++)
+					boolLENGTHK[t][l].push_back(csr.col(0.0, 1.0, 'B', name("boolLEN", t, l, p)));
+		}
+		if (t > 0 && harmonic.at(t))
+			PHASE[t] = csr.col(0.0, taskchain.at(t).period * (1 - TOL), 'C', name("PHASE", t));
+	}
+
+	const int OBJ = csr.col(-INT_MAX, INT_MAX, 'C', "OBJ");
+	csr.obj[OBJ] = 1;
+
+	//-----------------------------------------------------------------------------
+	// ROWS (numbered as in MILP_WH_K)
+	//-----------------------------------------------------------------------------
+
+	// CONSTRAINT 1
+	csr.term(OFFS[0], 1);
+	csr.row('E', 0);
+	csr.term(EFFECTIVEJOB[0][0], 1);
+	csr.row('E', 0);
+
+	// CONSTRAINT 3
+	if (!opts.open_head) {
+		for (int p = 0; p < P - 1; p++) {
+			csr.term(REDUNDHITS[0][p], 1);
+			csr.row('E', 0);
+		}
+		for (int p = 0; p < P; p++) {
+			csr.term(MISSAFTEREFFECTIVE[0][p], 1);
+			csr.row('E', 0);
+		}
+	}
+	if (opts.head_max_gap > 0) {
+		for (int p = 0; p < P - 1; p++) {
+			csr.term(EFFECTIVEJOB[0][p + 1], 1);
+			csr.term(EFFECTIVEJOB[0][p], -1);
+			csr.row('L', opts.head_max_gap);
+		}
+	}
+	if (!opts.open_tail) {
+		for (int p = 0; p < P - 1; p++) {
+			csr.term(VOIDHITS[N - 1][p], 1);
+			csr.row('E', 0);
+			if (!hard.at(N - 1)) {
+				csr.term(boolVOIDJOBS[N - 1][p], 1);
+				csr.row('E', 0);
+			}
+		}
+	}
+
+	// CONSTRAINT 4 (weakly-hard tasks only)
+	const int LAST_WITH_VOID = opts.open_tail ? N : N - 1;
+	for (int t = 0; t < LAST_WITH_VOID; t++) {
+		for (int p = 0; p < P - 1 && !hard.at(t); p++) {
+			csr.term(VOIDHITS[t][p], 1);
+			csr.term(boolVOIDJOBS[t][p], -BIGM);
+			csr.row('L', 0);
+			csr.term(VOIDHITS[t][p], 1);
+			csr.term(boolVOIDJOBS[t][p], -1);
+			csr.row('G', 0);
+		}
+	}
+
+	for (int t = 1; t < N; t++) {
+
+		const double Tt = taskchain.at(t).period;
+		const double Tt1 = taskchain.at(t - 1).period;
+		const double Dt1 = taskchain.at(t - 1).deadline;
+
+		for (int p = 0; p < P - 1; p++) {
+
+			// CONSTRAINT 5
+			if (!harmonic.at(t)) {
+				csr.term(OFFS[t], 1);
+				csr.term(EFFECTIVEJOB[t][p], Tt);
+				csr.term(OFFS[t - 1], -1);
+				csr.term(EFFECTIVEJOB[t - 1][p], -Tt1);
+				csr.row('G', Dt1);
+			}
+			csr.term(OFFS[t], 1);
+			csr.term(EFFECTIVEJOB[t][p], Tt);
+			csr.term(OFFS[t - 1], -1);
+			csr.term(EFFECTIVEJOB[t - 1][p + 1], -Tt1);
+			csr.row('L', Dt1 - TOL);
+
+			// CONSTRAINT 6 (implied by constraint 7 for hard producers)
+			if (!hard.at(t - 1)) {
+				csr.term(OFFS[t - 1], 1);
+				csr.term(EFFECTIVEJOB[t - 1][p], Tt1);
+				csr.term(REDUNDHITS[t - 1][p], Tt1);
+				csr.term(MISSWNEWINPUT[t - 1][p], Tt1);
+				csr.term(OFFS[t], -1);
+				csr.term(EFFECTIVEJOB[t][p], -Tt);
+				csr.term(boolVOIDJOBS[t - 1][p], -BIGM);
+				csr.row('G', -BIGM - Tt1 - Dt1 + TOL);
+			}
+
+			// CONSTRAINT 7
+			if (hard.at(t - 1)) {
+				csr.term(OFFS[t], 1);
+				csr.term(EFFECTIVEJOB[t][p], Tt);
+				csr.term(REDUNDHITS[t][p], Tt);
+				csr.term(OFFS[t - 1], -1);
+				csr.term(EFFECTIVEJOB[t - 1][p], -Tt1);
+				csr.term(REDUNDHITS[t - 1][p], -Tt1);
+				csr.row('L', Tt1 + Dt1 - TOL);
+			}
+			else {
+				csr.term(OFFS[t], 1);
+				csr.term(EFFECTIVEJOB[t][p], Tt);
+				csr.term(REDUNDHITS[t][p], Tt);
+				csr.term(OFFS[t - 1], -1);
+				csr.term(EFFECTIVEJOB[t - 1][p], -Tt1);
+				csr.term(REDUNDHITS[t - 1][p], -Tt1);
+				csr.term(MISSWNEWINPUT[t - 1][p], -Tt1);
+				csr.term(boolVOIDJOBS[t - 1][p], BIGM);
+				csr.row('L', Tt1 + Dt1 - TOL + BIGM);
+
+				csr.term(OFFS[t], 1);
+				csr.term(EFFECTIVEJOB[t][p], Tt);
+				csr.term(REDUNDHITS[t][p], Tt);
+				csr.term(OFFS[t - 1], -1);
+				csr.term(EFFECTIVEJOB[t - 1][p], -Tt1);
+				csr.term(REDUNDHITS[t - 1][p], -Tt1);
+				csr.term(MISSWNEWINPUT[t - 1][p], -Tt1);
+				csr.term(MISSAFTEREFFECTIVE[t - 1][p + 1], -Tt1);
+				csr.term(boolVOIDJOBS[t - 1][p], -BIGM);
+				csr.row('L', Tt1 + Dt1 - TOL);
+			}
+		}
+
+		// CONSTRAINT 8
+		for (int p = 0; p < P; p++) {
+			if (harmonic.at(t)) {
+				csr.term(OFFS[t], 1);
+				csr.term(EFFECTIVEJOB[t][p], Tt);
+				csr.term(MISSAFTEREFFECTIVE[t][p], -Tt);
+				csr.term(OFFS[t - 1], -1);
+				csr.term(EFFECTIVEJOB[t - 1][p], -Tt1);
+				csr.term(PHASE[t], -1);
+				csr.row('E', Dt1);
+				continue;
+			}
+
+			csr.term(MISSAFTEREFFECTIVE[t][p], 1);
+			csr.term(OFFS[t], -1 / Tt);
+			csr.term(EFFECTIVEJOB[t][p], -1);
+			csr.term(OFFS[t - 1], 1 / Tt);
+			csr.term(EFFECTIVEJOB[t - 1][p], Tt1 / Tt);
+			csr.row('G', -Dt1 / Tt - 1 + TOL);
+
+			csr.term(MISSAFTEREFFECTIVE[t][p], 1);
+			csr.term(OFFS[t], -1 / Tt);
+			csr.term(EFFECTIVEJOB[t][p], -1);
+			csr.term(OFFS[t - 1], 1 / Tt);
+			csr.term(EFFECTIVEJOB[t - 1][p], Tt1 / Tt);
+			csr.row('L', -Dt1 / Tt);
+		}
+	}
+
+	// CONSTRAINT 9
+	for (int t = 0; t < N; t++) {
+		for (int p = 0; p < P - 1; p++) {
+			csr.term(EFFECTIVEJOB[t][p + 1], 1);
+			csr.term(EFFECTIVEJOB[t][p], -1);
+			csr.term(REDUNDHITS[t][p], -1);
+			csr.term(MISSWNEWINPUT[t][p], -1);
+			csr.term(VOIDHITS[t][p], -1);
+			csr.term(MISSAFTEREFFECTIVE[t][p + 1], -1);
+			csr.row('E', 1);
+		}
+	}
+	for (int t = 0; t < N; t++) {
+		for (int p = 0; p < P - 1; p++) {
+			csr.term(EFFECTIVEJOB[t][p + 1], 1);
+			csr.term(EFFECTIVEJOB[t][p], -1);
+			csr.row('G', 1);
+		}
+	}
+
+	for (int t = 0; t < N; t++) {
+		if (hard.at(t))
+			continue;
+
+		const int mconsec = setofmk.at(t).mconsec;
+
+		// CONSTRAINT 10
+		for (int p = 0; p < P - 1; p++) {
+			csr.term(MISSWNEWINPUT[t][p], 1);
+			csr.row('L', mconsec);
+			csr.term(MISSAFTEREFFECTIVE[t][p], 1);
+			csr.row('L', mconsec);
+		}
+		csr.term(MISSAFTEREFFECTIVE[t][P - 1], 1);
+		csr.row('L', mconsec);
+
+		// CONSTRAINT 11
+		for (int p = 0; p < P - 1; p++) {
+			csr.term(MISSWNEWINPUT[t][p], 1);
+			csr.term(MISSAFTEREFFECTIVE[t][p + 1], 1);
+			csr.term(boolVOIDJOBS[t][p], -BIGM);
+			csr.row('L', mconsec);
+		}
+
+		// CONSTRAINT 12 & CONSTRAINT 13
+		auto check_mk = [&](const LinExpr &LENGTHSEQ, const LinExpr &NUMMISSES, int b) {
+			for (int i = 0; i < setofmk.at(t).mk.size(); i++) {
+				int m = setofmk.at(t).mk.at(i).m;
+				int k = setofmk.at(t).mk.at(i).k;
+
+				csr.terms(LENGTHSEQ, 1);
+				csr.term(b, BIGM);
+				csr.row('L', k + BIGM - LENGTHSEQ.constant);
+
+				csr.terms(LENGTHSEQ, 1);
+				csr.term(b, BIGM);
+				csr.row('G', k + 1 - LENGTHSEQ.constant);
+
+				csr.terms(NUMMISSES, 1);
+				csr.term(b, BIGM);
+				csr.row('L', m + BIGM - NUMMISSES.constant);
+
+				csr.terms(LENGTHSEQ, 1);
+				csr.terms(NUMMISSES, -1);
+				csr.term(b, BIGM);
+				csr.row('G', k - m - LENGTHSEQ.constant + NUMMISSES.constant);
+			}
+		};
+
+		// Sequences starting from MISSAFTEREFFECTIVE
+		for (int s = 0; s < P - 1; s++) {
+			LinExpr LENGTHSEQ, NUMMISSES;
+			LENGTHSEQ.add(MISSAFTEREFFECTIVE[t][s], 1);
+			NUMMISSES.add(MISSAFTEREFFECTIVE[t][s], 1);
+
+			for (int p = s; p < P - 1; p++) {
+				LENGTHSEQ.constant += 1;
+				LENGTHSEQ.add(REDUNDHITS[t][p], 1);
+				LENGTHSEQ.add(MISSWNEWINPUT[t][p], 1);
+				NUMMISSES.add(MISSWNEWINPUT[t][p], 1);
+				check_mk(LENGTHSEQ, NUMMISSES, boolLENGTHK[t][2 * s][2 * p]);
+
+				LENGTHSEQ.add(VOIDHITS[t][p], 1);
+				LENGTHSEQ.add(MISSAFTEREFFECTIVE[t][p + 1], 1);
+				NUMMISSES.add(MISSAFTEREFFECTIVE[t][p + 1], 1);
+				check_mk(LENGTHSEQ, NUMMISSES, boolLENGTHK[t][2 * s][2 * p + 1]);
+			}
+		}
+
+		// Sequences starting from MISSNEWINPUT
+		for (int s = 0; s < P - 1; s++) {
+			LinExpr LENGTHSEQ, NUMMISSES;
+			LENGTHSEQ.add(MISSWNEWINPUT[t][s], 1);
+			NUMMISSES.add(MISSWNEWINPUT[t][s], 1);
+
+			for (int p = s; p < P - 1; p++) {
+				LENGTHSEQ.add(VOIDHITS[t][p], 1);
+				LENGTHSEQ.add(MISSAFTEREFFECTIVE[t][p + 1], 1);
+				NUMMISSES.add(MISSAFTEREFFECTIVE[t][p + 1], 1);
+				check_mk(LENGTHSEQ, NUMMISSES, boolLENGTHK[t][2 * s + 1][2 * p]);
+
+				if (p < P - 2) {
+					LENGTHSEQ.constant += 1;
+					LENGTHSEQ.add(REDUNDHITS[t][p + 1], 1);
+					LENGTHSEQ.add(MISSWNEWINPUT[t][p + 1], 1);
+					NUMMISSES.add(MISSWNEWINPUT[t][p + 1], 1);
+					check_mk(LENGTHSEQ, NUMMISSES, boolLENGTHK[t][2 * s + 1][2 * p + 1]);
+				}
+			}
+		}
+	}
+
+	// VALID INEQUALITIES, in the model or in the user cut pool
+	CSRmodel cuts(0, opts.valid_as_cuts ? 4 * N * P : 0, opts.valid_as_cuts ? 40 * N * P : 0, false);
+	CSRmodel &valid = opts.valid_as_cuts ? cuts : csr;
+
+	for (int t = 1; t < N; t++) {
+
+		const double Tt = taskchain.at(t).period;
+		const double Tt1 = taskchain.at(t - 1).period;
+		const double Dt1 = taskchain.at(t - 1).deadline;
+		const int g = period_gcd(taskchain.at(t).period, taskchain.at(t - 1).period);
+		const double a = Tt / g;
+		const double b = Tt1 / g;
+
+		for (int p = 0; p < P - 1; p++) {
+
+			// Gaps of adjacent tasks between two paths
+			if ((opts.valid_ineq & VALID_EJ_RATIO) && !harmonic.at(t)) {
+				for (int dir = -1; dir <= 1; dir += 2) {
+					valid.term(EFFECTIVEJOB[t][p + 1], a);
+					valid.term(EFFECTIVEJOB[t][p], -a);
+					valid.term(MISSAFTEREFFECTIVE[t][p + 1], -a);
+					valid.term(MISSAFTEREFFECTIVE[t][p], a);
+					valid.term(EFFECTIVEJOB[t - 1][p + 1], -b);
+					valid.term(EFFECTIVEJOB[t - 1][p], b);
+					if (dir < 0)
+						valid.row('L', a - 1);
+					else
+						valid.row('G', 1 - a);
+				}
+			}
+
+			// Redundant jobs of the consumer against those of the producer
+			if (opts.valid_ineq & VALID_REDUND_COUPLING) {
+				if (!hard.at(t - 1)) {
+					valid.term(OFFS[t], 1);
+					valid.term(EFFECTIVEJOB[t][p], Tt);
+					valid.term(REDUNDHITS[t][p], Tt);
+					valid.term(OFFS[t - 1], -1);
+					valid.term(EFFECTIVEJOB[t - 1][p], -Tt1);
+					valid.term(REDUNDHITS[t - 1][p], -Tt1);
+					valid.term(MISSWNEWINPUT[t - 1][p], -Tt1);
+					valid.term(MISSAFTEREFFECTIVE[t - 1][p + 1], -Tt1);
+					valid.row('L', Tt1 + Dt1 - TOL);
+				}
+				valid.term(REDUNDHITS[t][p], a);
+				valid.term(MISSAFTEREFFECTIVE[t][p], a);
+				valid.term(REDUNDHITS[t - 1][p], -b);
+				valid.term(MISSWNEWINPUT[t - 1][p], -b);
+				valid.term(MISSAFTEREFFECTIVE[t - 1][p + 1], -b);
+				valid.row('L', b - 1);
+			}
+		}
+	}
+
+	// Range of the first effective job
+	if (opts.valid_ineq & VALID_EJ_BOUNDS) {
+		vector<int> lo, hi;
+		first_effective_job_bounds(taskchain, setofmk, hard, lo, hi);
+		for (int t = 1; t < N; t++) {
+			for (int p = 0; p < P; p++)
+				csr.lb[EFFECTIVEJOB[t][p]] = lo.at(t) + p;
+			csr.ub[EFFECTIVEJOB[t][0]] = hi.at(t);
+		}
+	}
+
+	// OBJECTIVE FUNCTION
+	const int tail = N - 1;
+	const double Tt = taskchain.at(tail).period;
+	const double Dt = taskchain.at(tail).deadline;
+
+	csr.term(OBJ, 1);
+	switch (mytarget) {
+	case MAXIMIZE_LATENCY:
+		csr.term(OFFS[tail], -1);
+		csr.term(EFFECTIVEJOB[tail][0], -Tt);
+		csr.row('L', Dt);
+		break;
+	case MAXIMIZE_DATAAGE:
+		csr.term(OFFS[tail], -1);
+		csr.term(EFFECTIVEJOB[tail][1], -Tt);
+		csr.row('L', 0);
+		break;
+	case MAXIMIZE_UPDATE_INT:
+		csr.term(EFFECTIVEJOB[tail][1], -Tt);
+		csr.term(EFFECTIVEJOB[tail][0], Tt);
+		csr.row('L', 0);
+		break;
+	case MINIMIZE_UPDATE_INT:
+		csr.term(EFFECTIVEJOB[tail][1], Tt);
+		csr.term(EFFECTIVEJOB[tail][0], -Tt);
+		csr.row('L', 0);
+		break;
+	default:
+		MILP_out.status = MILP_ERROR;
+		MILP_out.message = "Unknown optimization target";
+		return MILP_out;
+	}
+
+	//-----------------------------------------------------------------------------
+	// LOAD AND SOLVE
+	//-----------------------------------------------------------------------------
+
+	int status = 0;
+	CPXENVptr env = CPXopenCPLEX(&status);
+	if (env == NULL) {
+		MILP_out.status = MILP_ERROR;
+		MILP_out.message = "Could not open CPLEX environment";
+		return MILP_out;
+	}
+	CPXLPptr lp = CPXcreateprob(env, &status, "whchain");
+
+	vector<char*> colnames;
+	if (csr.named())
+		for (int j = 0; j < csr.colname.size(); j++)
+			colnames.push_back(&csr.colname[j][0]);
+
+	volatile int terminate = 0;
+	int race_id = -1;
+
+	if (lp != NULL)
+		status = CPXnewcols(env, lp, csr.obj.size(), csr.obj.data(), csr.lb.data(), csr.ub.data(), csr.ctype.data(),
+			csr.named() ? colnames.data() : NULL);
+	if (lp != NULL && status == 0)
+		status = CPXaddrows(env, lp, 0, csr.num_rows(), csr.rmatind.size(), csr.rhs.data(), csr.sense.data(),
+			csr.rmatbeg.data(), csr.rmatind.data(), csr.rmatval.data(), NULL, NULL);
+	if (lp != NULL && status == 0 && cuts.num_rows() > 0)
+		status = CPXaddusercuts(env, lp, cuts.num_rows(), cuts.rmatind.size(), cuts.rhs.data(), cuts.sense.data(),
+			cuts.rmatbeg.data(), cuts.rmatind.data(), cuts.rmatval.data(), NULL);
+	if (lp != NULL && status == 0)
+		status = CPXchgobjsen(env, lp, CPX_MAX);
+
+	if (lp != NULL && status == 0) {
+		CPXsetintparam(env, CPXPARAM_ScreenOutput, opts.verbose ? CPX_ON : 0);
+		if (!opts.export_model.empty())
+			CPXwriteprob(env, lp, opts.export_model.c_str(), NULL);
+
+		CPXsetdblparam(env, CPXPARAM_MIP_Tolerances_MIPGap, opts.epgap);
+		CPXsetdblparam(env, CPXPARAM_TimeLimit, opts.timelimit);
+		CPXsetintparam(env, CPXPARAM_Threads, opts.threads);
+		CPXsetintparam(env, CPXPARAM_Emphasis_MIP, opts.mipemphasis);
+		CPXsetintparam(env, CPXPARAM_MIP_Strategy_HeuristicFreq, opts.heurfreq);
+		if (opts.random_seed >= 0)
+			CPXsetintparam(env, CPXPARAM_RandomSeed, opts.random_seed);
+
+		if (opts.cuts != 0) {
+			const int cut_params[] = { CPXPARAM_MIP_Cuts_MIRCut, CPXPARAM_MIP_Cuts_FlowCovers, CPXPARAM_MIP_Cuts_Cliques,
+				CPXPARAM_MIP_Cuts_Covers, CPXPARAM_MIP_Cuts_GUBCovers, CPXPARAM_MIP_Cuts_Implied, CPXPARAM_MIP_Cuts_Gomory,
+				CPXPARAM_MIP_Cuts_Disjunctive, CPXPARAM_MIP_Cuts_ZeroHalfCut, CPXPARAM_MIP_Cuts_MCFCut,
+				CPXPARAM_MIP_Cuts_LiftProj };
+			for (int i = 0; i < sizeof(cut_params) / sizeof(cut_params[0]); i++)
+				CPXsetintparam(env, cut_params[i], opts.cuts);
+		}
+
+		// Branching priorities
+		vector<int> order;
+		for (int t = 0; t < N; t++) {
+			if (opts.branch_on == BRANCH_LENGTHK && !hard.at(t))
+				for (int l = 0; l < 2 * P; l++)
+					order.insert(order.end(), boolLENGTHK[t][l].begin(), boolLENGTHK[t][l].end());
+			else if (opts.branch_on == BRANCH_EFFECTIVEJOB)
+				order.insert(order.end(), EFFECTIVEJOB[t].begin(), EFFECTIVEJOB[t].end());
+		}
+		if (!order.empty()) {
+			vector<int> priority(order.size(), 1);
+			CPXcopyorder(env, lp, order.size(), order.data(), priority.data(), NULL);
+			CPXsetintparam(env, CPXPARAM_MIP_Strategy_Order, CPX_ON);
+		}
+
+		// Racing: the solve stops once the race is over
+		if (opts.race != NULL) {
+			CPXsetterminate(env, &terminate);
+			volatile int *flag = &terminate;
+			race_id = opts.race->register_abort([flag]() { *flag = 1; });
+		}
+
+		status = CPXmipopt(env, lp);
+
+		if (race_id >= 0)
+			opts.race->unregister_abort(race_id);
+	}
+
+	if (lp == NULL || status != 0) {
+		MILP_out.status = MILP_ERROR;
+		MILP_out.message = cpx_error(env, status);
+	}
+	else {
+		int solstat = CPXgetstat(env, lp);
+		MILP_out.nodes = CPXgetnodecnt(env, lp);
+		int method, soltype, pfeas, dfeas;
+		CPXsolninfo(env, lp, &method, &soltype, &pfeas, &dfeas);
+
+		if (solstat == CPXMIP_INFEASIBLE || solstat == CPXMIP_INForUNBD) {
+			MILP_out.status = MILP_INFEASIBLE;
+			MILP_out.message = "No solution available";
+		}
+		else if (soltype == CPX_NO_SOLN || !pfeas) {
+			MILP_out.status = MILP_NOSOLUTION;
+			MILP_out.message = "No solution available";
+		}
+		else {
+			MILP_out.status = (solstat == CPXMIP_OPTIMAL || solstat == CPXMIP_OPTIMAL_TOL) ? MILP_OPTIMAL : MILP_FEASIBLE;
+
+			if (MILP_out.status == MILP_OPTIMAL && opts.race != NULL)
+				opts.race->finish();
+
+			vector<double> x(csr.obj.size());
+			double objval, bestobj;
+			CPXgetx(env, lp, x.data(), 0, x.size() - 1);
+			CPXgetobjval(env, lp, &objval);
+			CPXgetbestobjval(env, lp, &bestobj);
+
+			MILP_out.objective = (mytarget == MINIMIZE_UPDATE_INT) ? -objval : objval;
+			MILP_out.bound = (mytarget == MINIMIZE_UPDATE_INT) ? -bestobj : bestobj;
+
+			for (int t = 0; t < N; t++) {
+				MILPtaskresult tr;
+				tr.taskid = taskchain.at(t).id;
+				tr.offset = x[OFFS[t]];
+				for (int p = 0; p < P; p++) {
+					tr.missaftereffective.push_back(round(x[MISSAFTEREFFECTIVE[t][p]]));
+					tr.effective.push_back(round(x[EFFECTIVEJOB[t][p]]));
+				}
+				for (int p = 0; p < P - 1; p++) {
+					tr.redundhits.push_back(round(x[REDUNDHITS[t][p]]));
+					tr.missnewinput.push_back(round(x[MISSWNEWINPUT[t][p]]));
+					tr.voidhits.push_back(round(x[VOIDHITS[t][p]]));
+				}
+				MILP_out.tasks.push_back(tr);
+			}
+		}
+	}
+
+	if (lp != NULL)
+		CPXfreeprob(env, &lp);
+	CPXcloseCPLEX(&env);
+
+	return MILP_out;
+}
@@ -0,0 +1,24 @@
+#ifndef MILP_BULK_H__
+#define MILP_BULK_H__
+
+#include <vector>
+
+#include "milp_data.h"
+
+//-----------------------------------------------------------------------------
+// Bulk construction of the model of MILP_WH_K
+//
+// The rows are assembled in preallocated CSR arrays (row starts, column indices, coefficients)
+// and loaded in one shot through the CPLEX callable library, without Concert objects.
+// The model is the one of MILP_WH_K (add_task_rows in milp_model.h), constraint by constraint:
+// changes to either builder must be mirrored in the other.
+// Racing stops the solve when the race is over, but incumbents are not shared.
+// No conflict refinement is done here (conflict_tasks stays empty): MILP_WH_K hands a proven
+// infeasibility to the Concert build when refine_conflict is set.
+//-----------------------------------------------------------------------------
+
+// setofmk already normalized; hard and harmonic as computed by MILP_WH_K for the chain
+MILPresult MILP_WH_K_bulk(const std::vector<Task> &taskchain, const std::vector<WHconstr> &setofmk,
+	const std::vector<bool> &hard, const std::vector<bool> &harmonic, OptTarget mytarget, const MILPoptions &opts);
+
+#endif
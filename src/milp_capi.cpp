@@ -0,0 +1,76 @@
+#include "milp_capi.h"
+#include "milp_WHchain.h"
+
+using namespace std;
+
+
+void whc_default_options(whc_options *opts)
+{
+	MILPoptions defaults;
+
+	opts->epgap = defaults.epgap;
+	opts->timelimit = defaults.timelimit;
+	opts->threads = defaults.threads;
+	opts->verbose = defaults.verbose;
+}
+
+
+int whc_analyze(const whc_task *tasks, const whc_constr *constr, int num_tasks, int target,
+	const whc_options *opts, whc_result *result)
+{
+	MILPresult res;
+
+	if (tasks == NULL || constr == NULL || result == NULL || num_tasks <= 0 
+		|| target < MAXIMIZE_LATENCY || target > MINIMIZE_UPDATE_INT) {
+		res.status = MILP_ERROR;
+	}
+	else {
+		vector<Task> taskchain;
+		vector<WHconstr> setofmk;
+
+		for (int t = 0; t < num_tasks; t++) {
+			Task task;
+			task.id = tasks[t].id;
+			task.deadline = tasks[t].deadline;
+			task.period = tasks[t].period;
+			task.core_id = tasks[t].core_id;
+			taskchain.push_back(task);
+
+			WHconstr whc;
+			whc.taskid = constr[t].taskid;
+			whc.mconsec = constr[t].mconsec;
+			for (int i = 0; i < constr[t].num_mk; i++) {
+				MKconstr mkc;
+				mkc.m = constr[t].mk[i].m;
+				mkc.k = constr[t].mk[i].k;
+				whc.mk.push_back(mkc);
+			}
+			setofmk.push_back(whc);
+		}
+
+		MILPoptions milpopts;
+		if (opts != NULL) {
+			milpopts.epgap = opts->epgap;
+			milpopts.timelimit = opts->timelimit;
+			milpopts.threads = opts->threads;
+			milpopts.verbose = (opts->verbose != 0);
+		}
+
+		try {
+			res = MILP_WH_K(taskchain, setofmk, static_cast<OptTarget>(target), milpopts);
+		}
+		catch (...) {
+			// Never let an exception cross the C boundary
+			res.status = MILP_ERROR;
+		}
+	}
+
+	if (result != NULL) {
+		result->status = res.status;
+		result->objective = res.objective;
+		result->bound = res.bound;
+		result->runtime = res.runtime;
+	}
+
+	return res.status;
+}
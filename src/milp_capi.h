@@ -0,0 +1,55 @@
+#ifndef MILP_CAPI_H__
+#define MILP_CAPI_H__
+
+/* C interface to the weakly-hard chain analysis (see milp_WHchain.h) */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+	int id;
+	int deadline;
+	int period;
+	int core_id;
+} whc_task;
+
+typedef struct {
+	int m;
+	int k;
+} whc_mk;
+
+typedef struct {
+	int taskid;
+	int mconsec;
+	int num_mk;
+	const whc_mk *mk;
+} whc_constr;
+
+typedef struct {
+	double epgap;
+	double timelimit;
+	int threads;
+	int verbose;
+} whc_options;
+
+typedef struct {
+	int status;			/* values of MILPstatus */
+	double objective;
+	double bound;
+	double runtime;
+} whc_result;
+
+/* Fill the options with the defaults of MILPoptions */
+void whc_default_options(whc_options *opts);
+
+/* Analyze a chain of num_tasks tasks, constr[t] being the constraint of tasks[t].
+   target takes the values of OptTarget. Returns the status stored in result. */
+int whc_analyze(const whc_task *tasks, const whc_constr *constr, int num_tasks, int target,
+	const whc_options *opts, whc_result *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,163 @@
+#include "milp_compose.h"
+#include "milp_WHchain.h"
+
+#include <future>
+#include <chrono>
+#include <cmath>
+
+using namespace std;
+
+#define TOL_GAP 0.001
+
+
+// Analysis of positions [first, last] of the chain as a stand-alone sub-chain
+static MILPresult solve_subchain(const vector<Task> &taskchain, const vector<WHconstr> &setofmk,
+	int first, int last, OptTarget mytarget, MILPoptions opts, int head_max_gap)
+{
+	vector<Task> subchain(taskchain.begin() + first, taskchain.begin() + last + 1);
+	vector<WHconstr> submk(setofmk.begin() + first, setofmk.begin() + last + 1);
+
+	opts.open_head = (first > 0);
+	opts.open_tail = (last < (int)taskchain.size() - 1);
+	opts.head_max_gap = head_max_gap;
+	opts.export_model.clear();
+	opts.results_file.clear();
+
+	return MILP_WH_K(subchain, submk, mytarget, opts);
+}
+
+
+static bool has_bound(const MILPresult &res)
+{
+	return res.status == MILP_OPTIMAL || res.status == MILP_FEASIBLE;
+}
+
+
+ComposedResult MILP_WH_K_compositional(const vector<Task> &taskchain, const vector<WHconstr> &setofmk,
+	OptTarget mytarget, const ComposeOptions &copts)
+{
+	auto start_time = chrono::steady_clock::now();
+
+	ComposedResult out;
+	const int N = taskchain.size();
+	const int window = max(2, copts.window);
+
+	// Overlapping sub-chains, sharing their boundary task
+	vector<SubchainResult> parts;
+	int first = 0;
+	while (N > 0) {
+		SubchainResult part;
+		part.first = first;
+		part.last = min(first + window - 1, N - 1);
+		part.tail_max_gap = 0;
+		parts.push_back(part);
+		if (part.last == N - 1)
+			break;
+		first = part.last;
+	}
+
+	if (parts.empty())
+		return out;
+
+	const int S = parts.size();
+
+	// Latencies of the sub-chains before the last one do not depend on any interface:
+	// solve them all in parallel right away
+	vector<future<MILPresult> > latencies;
+	if (mytarget == MAXIMIZE_LATENCY || mytarget == MAXIMIZE_DATAAGE) {
+		int num_latencies = (mytarget == MAXIMIZE_LATENCY) ? S : S - 1;
+		for (int i = 0; i < num_latencies; i++) {
+			latencies.push_back(async(launch::async, solve_subchain, cref(taskchain), cref(setofmk),
+				parts.at(i).first, parts.at(i).last, MAXIMIZE_LATENCY, copts.milp, 0));
+		}
+	}
+
+	// Interfaces: largest number of jobs of each boundary task between two paths, sub-chain after sub-chain
+	vector<MILPresult> interfaces(S);
+	if (mytarget != MAXIMIZE_LATENCY) {
+		int head_gap = 0;
+		for (int i = 0; i < S - 1; i++) {
+			interfaces.at(i) = solve_subchain(taskchain, setofmk, parts.at(i).first, parts.at(i).last,
+				MAXIMIZE_UPDATE_INT, copts.milp, head_gap);
+
+			head_gap = 0;
+			if (has_bound(interfaces.at(i))) {
+				int Tb = taskchain.at(parts.at(i).last).period;
+				head_gap = max(1, (int)floor(interfaces.at(i).bound / Tb + TOL_GAP));
+			}
+			parts.at(i).tail_max_gap = head_gap;
+		}
+
+		// Data age of the last sub-chain, or update interval (the last sub-chain relaxes the whole chain)
+		parts.at(S - 1).res = solve_subchain(taskchain, setofmk, parts.at(S - 1).first, parts.at(S - 1).last,
+			mytarget, copts.milp, head_gap);
+	}
+
+	for (int i = 0; i < latencies.size(); i++)
+		parts.at(i).res = latencies.at(i).get();
+
+	//-----------------------------------------------------------------------------
+	// COMPOSITION
+	//-----------------------------------------------------------------------------
+
+	MILPstatus status = MILP_OPTIMAL;
+	double bound = 0;
+
+	if (mytarget == MAXIMIZE_LATENCY || mytarget == MAXIMIZE_DATAAGE) {
+		for (int i = 0; i < S; i++) {
+			status = max(status, parts.at(i).res.status);
+			bound += parts.at(i).res.bound;
+			if (i < S - 1)
+				bound -= taskchain.at(parts.at(i).last).deadline;
+		}
+	}
+	else {
+		status = parts.at(S - 1).res.status;
+		bound = parts.at(S - 1).res.bound;
+	}
+
+	// Interfaces that could not be computed only loosen the bound
+	for (int i = 0; i < S - 1; i++) {
+		if (interfaces.at(i).status == MILP_INFEASIBLE || interfaces.at(i).status == MILP_ERROR)
+			status = max(status, interfaces.at(i).status);
+	}
+
+	out.status = status;
+	out.bound = bound;
+	out.parts = parts;
+
+	auto end_time = chrono::steady_clock::now();
+	out.runtime = chrono::duration<double>(end_time - start_time).count();
+
+	return out;
+}
+
+
+CompositionReport compare_compositional(const vector<Task> &taskchain, const vector<WHconstr> &setofmk,
+	OptTarget mytarget, const ComposeOptions &copts)
+{
+	CompositionReport report;
+
+	report.composed = MILP_WH_K_compositional(taskchain, setofmk, mytarget, copts);
+
+	MILPoptions opts = copts.milp;
+	opts.export_model.clear();
+	opts.results_file.clear();
+	report.monolithic = MILP_WH_K(taskchain, setofmk, mytarget, opts);
+
+	report.pessimism = 0;
+	if (has_bound(report.monolithic) && has_bound(report.composed.parts.back().res)) {
+		double exact = report.monolithic.objective;
+		double composed = report.composed.bound;
+		if (mytarget == MINIMIZE_UPDATE_INT) {
+			// Composed value is a lower bound
+			if (composed > 0)
+				report.pessimism = (exact - composed) / composed;
+		}
+		else if (exact > 0) {
+			report.pessimism = (composed - exact) / exact;
+		}
+	}
+
+	return report;
+}
@@ -0,0 +1,54 @@
+#ifndef MILP_COMPOSE_H__
+#define MILP_COMPOSE_H__
+
+#include <vector>
+
+#include "milp_data.h"
+
+//-----------------------------------------------------------------------------
+// Compositional analysis of long chains
+//
+// The chain is split into sub-chains of at most `window` tasks, consecutive sub-chains sharing
+// their boundary task. Each sub-chain is analyzed alone, with an open head (unknown producer) and
+// an open tail (unknown consumer), so its model relaxes the behavior of the same tasks inside the
+// whole chain and its bounds are safe. End-to-end bounds are composed at the boundary task b:
+//   latency   <= sum of sub-chain latencies - sum of D_b
+//   data age  <= sum of sub-chain latencies (all but last) - sum of D_b + data age of the last
+//   update interval: from the last sub-chain alone
+// The interface passed across b is the largest number of jobs of b between two paths, obtained
+// from the maximum update interval of b in the sub-chain ending at b.
+//-----------------------------------------------------------------------------
+
+struct ComposeOptions {
+	int window = 8;				// tasks per sub-chain (at least 2)
+	MILPoptions milp;			// settings of every sub-chain analysis
+};
+
+struct SubchainResult {
+	int first;					// positions in the chain
+	int last;
+	MILPresult res;				// target of the sub-chain (latency, data age or update interval)
+	int tail_max_gap;			// interface to the next sub-chain (0: not computed)
+};
+
+struct ComposedResult {
+	MILPstatus status = MILP_ERROR;	// worst status of the sub-chain analyses
+	double bound = 0;			// safe bound on the target (upper, or lower for MINIMIZE_UPDATE_INT)
+	double runtime = 0;			// wall-clock seconds
+	std::vector<SubchainResult> parts;
+};
+
+struct CompositionReport {
+	ComposedResult composed;
+	MILPresult monolithic;
+	double pessimism;			// relative distance of the composed bound from the monolithic objective
+};
+
+ComposedResult MILP_WH_K_compositional(const std::vector<Task> &taskchain, const std::vector<WHconstr> &setofmk,
+	OptTarget mytarget, const ComposeOptions &copts);
+
+// Compositional and monolithic analysis of the same chain, for chains where both are affordable
+CompositionReport compare_compositional(const std::vector<Task> &taskchain, const std::vector<WHconstr> &setofmk,
+	OptTarget mytarget, const ComposeOptions &copts);
+
+#endif
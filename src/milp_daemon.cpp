@@ -0,0 +1,450 @@
+#include "milp_daemon.h"
+#include "milp_WHchain.h"
+
+#include <cstring>
+#include <system_error>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+using namespace std;
+
+
+//-----------------------------------------------------------------------------
+// WIRE HELPERS
+//-----------------------------------------------------------------------------
+
+static bool read_full(int fd, void *buf, size_t len)
+{
+	char *p = static_cast<char*>(buf);
+	while (len > 0) {
+		ssize_t n = read(fd, p, len);
+		if (n <= 0)
+			return false;
+		p += n;
+		len -= n;
+	}
+	return true;
+}
+
+static bool write_full(int fd, const void *buf, size_t len)
+{
+	const char *p = static_cast<const char*>(buf);
+	while (len > 0) {
+		ssize_t n = write(fd, p, len);
+		if (n <= 0)
+			return false;
+		p += n;
+		len -= n;
+	}
+	return true;
+}
+
+static bool read_int(int fd, int32_t &v) { return read_full(fd, &v, sizeof(v)); }
+static bool read_double(int fd, double &v) { return read_full(fd, &v, sizeof(v)); }
+
+static void put_int(vector<char> &buf, int32_t v)
+{
+	const char *p = reinterpret_cast<const char*>(&v);
+	buf.insert(buf.end(), p, p + sizeof(v));
+}
+
+static void put_double(vector<char> &buf, double v)
+{
+	const char *p = reinterpret_cast<const char*>(&v);
+	buf.insert(buf.end(), p, p + sizeof(v));
+}
+
+// Read the body of a query, after its magic number
+static bool read_query(int fd, DaemonQuery &query)
+{
+	int32_t priority, target, num_tasks;
+
+	if (!read_int(fd, priority) || !read_int(fd, target) || !read_int(fd, num_tasks))
+		return false;
+	if (num_tasks <= 0 || num_tasks > UINT16_MAX)
+		return false;
+
+	query.priority = priority;
+	query.target = static_cast<OptTarget>(target);
+	query.taskchain.clear();
+	query.setofmk.clear();
+
+	for (int t = 0; t < num_tasks; t++) {
+		int32_t id, period, deadline, mconsec, num_mk;
+
+		if (!read_int(fd, id) || !read_int(fd, period) || !read_int(fd, deadline)
+			|| !read_int(fd, mconsec) || !read_int(fd, num_mk))
+			return false;
+		if (num_mk < 0 || num_mk > UINT16_MAX)
+			return false;
+
+		Task task;
+		task.id = id;
+		task.period = period;
+		task.deadline = deadline;
+		query.taskchain.push_back(task);
+
+		WHconstr whc;
+		whc.taskid = id;
+		whc.mconsec = mconsec;
+		for (int i = 0; i < num_mk; i++) {
+			int32_t m, k;
+			if (!read_int(fd, m) || !read_int(fd, k))
+				return false;
+			MKconstr mkc;
+			mkc.m = m;
+			mkc.k = k;
+			whc.mk.push_back(mkc);
+		}
+		query.setofmk.push_back(whc);
+	}
+
+	return read_double(fd, query.epgap) && read_double(fd, query.timelimit);
+}
+
+static bool write_reply(int fd, const DaemonReply &reply)
+{
+	vector<char> buf;
+	put_int(buf, DAEMON_REPLY_MAGIC);
+	put_int(buf, reply.status);
+	put_int(buf, reply.cached ? 1 : 0);
+	put_double(buf, reply.objective);
+	put_double(buf, reply.bound);
+	put_double(buf, reply.runtime);
+
+	return write_full(fd, buf.data(), buf.size());
+}
+
+// Key of a query in the cache: chain, target and the settings that change the answer
+static uint64_t query_key(const DaemonQuery &query)
+{
+	uint64_t h = chain_hash(query.taskchain, query.setofmk);
+
+	uint64_t extra[3];
+	extra[0] = static_cast<uint64_t>(query.target);
+	memcpy(&extra[1], &query.epgap, sizeof(double));
+	memcpy(&extra[2], &query.timelimit, sizeof(double));
+
+	for (int i = 0; i < 3; i++) {
+		h ^= extra[i] + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+	}
+	return h;
+}
+
+
+//-----------------------------------------------------------------------------
+// SERVER
+//-----------------------------------------------------------------------------
+
+AnalysisServer::AnalysisServer(const DaemonConfig &config)
+	: config(config), listen_fd(-1), stopping(false), next_seq(0), next_ticket(0)
+{
+}
+
+
+AnalysisServer::~AnalysisServer()
+{
+	stop();
+}
+
+
+int AnalysisServer::run()
+{
+	int fd_listen = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd_listen < 0)
+		return -1;
+
+	sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (config.socket_path.size() >= sizeof(addr.sun_path)) {
+		close(fd_listen);
+		return -1;
+	}
+	strncpy(addr.sun_path, config.socket_path.c_str(), sizeof(addr.sun_path) - 1);
+
+	unlink(config.socket_path.c_str());
+	if (bind(fd_listen, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(fd_listen, 128) < 0) {
+		close(fd_listen);
+		return -1;
+	}
+
+	// Published for stop(), which may already have been called
+	{
+		lock_guard<mutex> lock(conn_mutex);
+		listen_fd = fd_listen;
+		if (stopping)
+			shutdown(listen_fd, SHUT_RDWR);
+	}
+
+	for (int w = 0; w < max(1, config.workers); w++)
+		workers.push_back(thread(&AnalysisServer::worker_loop, this));
+
+	while (!stopping) {
+		int fd = accept(fd_listen, NULL, NULL);
+		if (fd < 0) {
+			if (stopping)
+				break;
+			continue;
+		}
+
+		lock_guard<mutex> lock(conn_mutex);
+		connection_fds.insert(fd);
+		try {
+			thread(&AnalysisServer::serve_connection, this, fd).detach();
+		}
+		catch (const system_error &) {
+			// Out of threads: drop this client, keep serving the others
+			connection_fds.erase(fd);
+			close(fd);
+		}
+	}
+
+	{
+		lock_guard<mutex> lock(conn_mutex);
+		listen_fd = -1;
+		close(fd_listen);
+	}
+
+	// Wake up and join everything
+	{
+		lock_guard<mutex> lock(queue_mutex);
+		queue_cv.notify_all();
+		reply_cv.notify_all();
+	}
+	for (int w = 0; w < workers.size(); w++)
+		workers.at(w).join();
+	workers.clear();
+
+	// Only live fds are in the set: a closed one may already belong to another file
+	{
+		unique_lock<mutex> lock(conn_mutex);
+		for (auto it = connection_fds.begin(); it != connection_fds.end(); ++it)
+			shutdown(*it, SHUT_RDWR);
+		conn_cv.wait(lock, [this] { return connection_fds.empty(); });
+	}
+
+	unlink(config.socket_path.c_str());
+	return 0;
+}
+
+
+void AnalysisServer::stop()
+{
+	if (stopping.exchange(true))
+		return;
+
+	// Wakes up accept(); run() closes the socket
+	lock_guard<mutex> lock(conn_mutex);
+	if (listen_fd >= 0)
+		shutdown(listen_fd, SHUT_RDWR);
+}
+
+
+void AnalysisServer::worker_loop()
+{
+	// Warm solver environment of this worker
+	MILPworkspace *ws = MILP_create_workspace();
+
+	MILPoptions opts;
+	opts.threads = config.solver_threads;
+
+	while (true) {
+		shared_ptr<Pending> job;
+		{
+			unique_lock<mutex> lock(queue_mutex);
+			queue_cv.wait(lock, [this] { return stopping || !queue.empty(); });
+			if (stopping)
+				break;
+
+			job = queue.top();
+			queue.pop();
+			if (job->cancelled)
+				continue;
+
+			// From now on identical queries queue up as new jobs (or hit the cache)
+			pending_by_key.erase(job->key);
+		}
+
+		opts.epgap = job->query.epgap;
+		opts.timelimit = job->query.timelimit;
+
+		DaemonReply reply;
+		MILPresult res = MILP_WH_K(job->query.taskchain, job->query.setofmk, job->query.target, opts, ws);
+		reply.status = res.status;
+		reply.objective = res.objective;
+		reply.bound = res.bound;
+		reply.runtime = res.runtime;
+
+		if (res.status != MILP_ERROR)
+			store_cache(job->key, reply);
+
+		{
+			lock_guard<mutex> lock(queue_mutex);
+			for (int i = 0; i < job->waiters.size(); i++)
+				replies[job->waiters.at(i)] = reply;
+		}
+		reply_cv.notify_all();
+	}
+
+	MILP_free_workspace(ws);
+}
+
+
+DaemonReply AnalysisServer::submit(const DaemonQuery &query)
+{
+	uint64_t key = query_key(query);
+
+	DaemonReply reply;
+	if (lookup_cache(key, reply))
+		return reply;
+
+	unique_lock<mutex> lock(queue_mutex);
+	int ticket = next_ticket++;
+
+	auto it = pending_by_key.find(key);
+	if (it != pending_by_key.end()) {
+		// Batch with the identical query already waiting, at the higher of the two priorities
+		it->second->waiters.push_back(ticket);
+		if (query.priority > it->second->query.priority) {
+			shared_ptr<Pending> raised = make_shared<Pending>(*it->second);
+			raised->query.priority = query.priority;
+			it->second->cancelled = true;
+			it->second = raised;
+			queue.push(raised);
+		}
+	}
+	else {
+		shared_ptr<Pending> job = make_shared<Pending>();
+		job->key = key;
+		job->seq = next_seq++;
+		job->cancelled = false;
+		job->query = query;
+		job->waiters.push_back(ticket);
+		pending_by_key[key] = job;
+		queue.push(job);
+	}
+	queue_cv.notify_one();
+
+	reply_cv.wait(lock, [this, ticket] { return stopping || replies.count(ticket) > 0; });
+	if (replies.count(ticket) > 0) {
+		reply = replies[ticket];
+		replies.erase(ticket);
+	}
+	return reply;
+}
+
+
+void AnalysisServer::serve_connection(int fd)
+{
+	int32_t magic;
+
+	while (!stopping && read_int(fd, magic)) {
+
+		DaemonQuery query;
+		if (magic != DAEMON_QUERY_MAGIC || !read_query(fd, query))
+			break;
+
+		DaemonReply reply;
+		if (query.target >= MAXIMIZE_LATENCY && query.target <= MINIMIZE_UPDATE_INT)
+			reply = submit(query);
+
+		if (!write_reply(fd, reply))
+			break;
+	}
+
+	lock_guard<mutex> lock(conn_mutex);
+	connection_fds.erase(fd);
+	close(fd);
+	conn_cv.notify_all();
+}
+
+
+bool AnalysisServer::lookup_cache(uint64_t key, DaemonReply &reply)
+{
+	lock_guard<mutex> lock(cache_mutex);
+
+	auto it = cache.find(key);
+	if (it == cache.end())
+		return false;
+
+	reply = it->second;
+	reply.cached = true;
+	return true;
+}
+
+
+void AnalysisServer::store_cache(uint64_t key, const DaemonReply &reply)
+{
+	lock_guard<mutex> lock(cache_mutex);
+
+	if (config.cache_size == 0 || cache.count(key) > 0)
+		return;
+
+	cache[key] = reply;
+	cache_order.push_back(key);
+
+	// Oldest results leave first
+	while (cache.size() > config.cache_size) {
+		cache.erase(cache_order.front());
+		cache_order.pop_front();
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// CLIENT
+//-----------------------------------------------------------------------------
+
+bool query_daemon(const string &socket_path, const DaemonQuery &query, DaemonReply &reply)
+{
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0)
+		return false;
+
+	sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+
+	if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+		close(fd);
+		return false;
+	}
+
+	vector<char> buf;
+	put_int(buf, DAEMON_QUERY_MAGIC);
+	put_int(buf, query.priority);
+	put_int(buf, query.target);
+	put_int(buf, query.taskchain.size());
+	for (int t = 0; t < query.taskchain.size(); t++) {
+		const WHconstr &whc = query.setofmk.at(t);
+		put_int(buf, query.taskchain.at(t).id);
+		put_int(buf, query.taskchain.at(t).period);
+		put_int(buf, query.taskchain.at(t).deadline);
+		put_int(buf, whc.mconsec);
+		put_int(buf, whc.mk.size());
+		for (int i = 0; i < whc.mk.size(); i++) {
+			put_int(buf, whc.mk.at(i).m);
+			put_int(buf, whc.mk.at(i).k);
+		}
+	}
+	put_double(buf, query.epgap);
+	put_double(buf, query.timelimit);
+
+	bool ok = write_full(fd, buf.data(), buf.size());
+
+	int32_t magic, status, cached;
+	ok = ok && read_int(fd, magic) && magic == DAEMON_REPLY_MAGIC;
+	ok = ok && read_int(fd, status) && read_int(fd, cached);
+	ok = ok && read_double(fd, reply.objective) && read_double(fd, reply.bound) && read_double(fd, reply.runtime);
+
+	if (ok) {
+		reply.status = static_cast<MILPstatus>(status);
+		reply.cached = (cached != 0);
+	}
+
+	close(fd);
+	return ok;
+}
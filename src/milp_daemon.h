@@ -0,0 +1,121 @@
+#ifndef MILP_DAEMON_H__
+#define MILP_DAEMON_H__
+
+#include <vector>
+#include <string>
+#include <deque>
+#include <queue>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+
+#include "milp_data.h"
+
+//-----------------------------------------------------------------------------
+// Resident analysis service over a Unix domain socket
+//
+// Wire format (native byte order, int32 unless noted), one or more queries per connection:
+//   query:  DAEMON_QUERY_MAGIC, priority, target, num_tasks,
+//           per task: id, period, deadline, mconsec, num_mk, num_mk x (m, k)
+//           epgap (double), timelimit (double)
+//   reply:  DAEMON_REPLY_MAGIC, status, cached,
+//           objective (double), bound (double), runtime (double)
+// Higher priorities are served first. Identical queries waiting in the queue are solved once.
+//-----------------------------------------------------------------------------
+
+#define DAEMON_QUERY_MAGIC 0x51434857	// "WHCQ"
+#define DAEMON_REPLY_MAGIC 0x52434857	// "WHCR"
+
+struct DaemonConfig {
+	std::string socket_path = "/tmp/whchain.sock";
+	int workers = 1;				// analyses solved concurrently, each with its own warm environment
+	int solver_threads = 1;			// solver threads of each analysis
+	size_t cache_size = 100000;		// results kept for repeated queries
+};
+
+struct DaemonQuery {
+	int priority = 0;
+	OptTarget target = MAXIMIZE_LATENCY;
+	std::vector<Task> taskchain;
+	std::vector<WHconstr> setofmk;
+	double epgap = 1e-2;
+	double timelimit = 7200;
+};
+
+struct DaemonReply {
+	MILPstatus status = MILP_ERROR;
+	bool cached = false;
+	double objective = 0;
+	double bound = 0;
+	double runtime = 0;
+};
+
+class AnalysisServer {
+public:
+	AnalysisServer(const DaemonConfig &config);
+	~AnalysisServer();
+
+	// Serve until stop() is called. Returns 0 on a clean stop, -1 if the socket cannot be set up.
+	int run();
+	void stop();
+
+private:
+	struct Pending {
+		uint64_t key;
+		uint64_t seq;
+		DaemonQuery query;
+		std::vector<int> waiters;		// tickets of the connections waiting for this query
+		bool cancelled;					// superseded by a copy with higher priority
+	};
+
+	struct PendingOrder {
+		bool operator()(const std::shared_ptr<Pending> &a, const std::shared_ptr<Pending> &b) const {
+			if (a->query.priority != b->query.priority)
+				return a->query.priority < b->query.priority;
+			return a->seq > b->seq;
+		}
+	};
+
+	void worker_loop();
+	void serve_connection(int fd);
+	DaemonReply submit(const DaemonQuery &query);
+	bool lookup_cache(uint64_t key, DaemonReply &reply);
+	void store_cache(uint64_t key, const DaemonReply &reply);
+
+	DaemonConfig config;
+	int listen_fd;						// guarded by conn_mutex: stop() comes from another thread
+	std::atomic<bool> stopping;
+
+	std::mutex queue_mutex;
+	std::condition_variable queue_cv;
+	std::priority_queue<std::shared_ptr<Pending>, std::vector<std::shared_ptr<Pending> >, PendingOrder> queue;
+	std::unordered_map<uint64_t, std::shared_ptr<Pending> > pending_by_key;
+	uint64_t next_seq;
+
+	// Replies handed from the workers to the connections, by ticket
+	std::condition_variable reply_cv;
+	std::map<int, DaemonReply> replies;
+	int next_ticket;
+
+	std::mutex cache_mutex;
+	std::unordered_map<uint64_t, DaemonReply> cache;
+	std::deque<uint64_t> cache_order;
+
+	std::vector<std::thread> workers;
+
+	// Connections are served by detached threads; each one removes its fd before closing it
+	std::mutex conn_mutex;
+	std::condition_variable conn_cv;
+	std::set<int> connection_fds;
+};
+
+// Client side: send one query to a running service. Returns false on connection or protocol errors.
+bool query_daemon(const std::string &socket_path, const DaemonQuery &query, DaemonReply &reply);
+
+#endif
@@ -12,6 +12,7 @@ struct Task {
 	int period;
 	std::string name;
 	int core_id = 0;
+	int wcet = 0;					// same unit as the period (0: not counted in the utilization)
 };
 
 struct MKconstr {
@@ -50,4 +51,82 @@ enum mkTasks {
 	MIX = 3
 };
 
+enum BranchOn {
+	BRANCH_DEFAULT = 0,
+	BRANCH_LENGTHK = 1,			// boolLENGTHK first
+	BRANCH_EFFECTIVEJOB = 2		// EFFECTIVEJOB first
+};
+
+// Structural valid inequalities, combined as a bitmask in MILPoptions::valid_ineq
+enum ValidIneq {
+	VALID_NONE = 0,
+	VALID_EJ_RATIO = 1,			// gaps between effective jobs of adjacent tasks, in the ratio of their periods
+	VALID_REDUND_COUPLING = 2,	// redundant jobs of the consumer against those of the producer, without big-M
+	VALID_EJ_BOUNDS = 4,		// bounds on the first effective job from the longest admissible latency
+	VALID_ALL = 7
+};
+
+enum MILPstatus {
+	MILP_OPTIMAL = 0,
+	MILP_FEASIBLE = 1,
+	MILP_INFEASIBLE = 2,
+	MILP_NOSOLUTION = 3,
+	MILP_ERROR = 4,
+	MILP_INVALID = 5			// rejected before building the model (see validate_chain)
+};
+
+class MILPrace;
+class MILPprofiles;
+
+// Solver settings and side effects of a single analysis
+struct MILPoptions {
+	double epgap = 1e-2;			// relative MIP gap
+	double timelimit = 7200;		// seconds
+	int threads = 4;
+	int mipemphasis = 0;			// CPLEX MIP emphasis (0: balanced)
+	int cuts = 0;					// all cut families: -1 off, 0 automatic, 1 moderate, 2 aggressive
+	int heurfreq = 0;				// heuristic frequency: -1 off, 0 automatic, n every n nodes
+	BranchOn branch_on = BRANCH_DEFAULT;
+	int random_seed = -1;			// -1: solver default
+	int valid_ineq = VALID_NONE;	// structural valid inequalities (ValidIneq bitmask)
+	bool valid_as_cuts = true;		// valid inequalities in the user cut pool rather than in the model
+	MILPrace *race = nullptr;		// portfolio race this analysis takes part in (see milp_race.h)
+	const MILPprofiles *profiles = nullptr;	// tuned emphasis, cuts, heurfreq and branch_on per class of chains (see milp_tune.h)
+	bool validate = true;			// reject malformed and inconsistent chains before building the model
+	bool refine_conflict = true;	// on infeasibility, find the tasks of a minimal conflict (with bulk_build: solved again with Concert)
+	bool bulk_build = false;		// assemble the model in CSR arrays and load it in one shot (see milp_bulk.h)
+	bool var_names = false;			// name the variables (always done when the model is exported)
+	bool normalize_wh = true;		// drop dominated (m,k) pairs and tighten mconsec
+	bool hard_presolve = true;		// drop miss variables, void binaries, big-M and (m,k) rows of hard tasks
+	bool harmonic_links = true;		// constant-phase formulation of links with harmonic periods
+	bool open_head = false;			// head may have redundant jobs and misses (sub-chain of a longer chain)
+	bool open_tail = false;			// tail may have void jobs (sub-chain of a longer chain)
+	int head_max_gap = 0;			// max jobs of the head between two paths (0: unbounded)
+	bool verbose = false;			// progress and solver log on stdout
+	std::string export_model;		// .lp file to export the model to (empty: none)
+	std::string results_file;		// per-task solution table (empty: none)
+};
+
+// Solution values of one task of the chain, one entry per path
+struct MILPtaskresult {
+	int taskid;
+	double offset;
+	std::vector<int> effective;
+	std::vector<int> missaftereffective;
+	std::vector<int> redundhits;
+	std::vector<int> missnewinput;
+	std::vector<int> voidhits;
+};
+
+struct MILPresult {
+	MILPstatus status = MILP_ERROR;
+	double objective = 0;			// value of the chosen target
+	double bound = 0;				// best bound on the target proved by the solver
+	double runtime = 0;				// seconds
+	long long nodes = 0;			// branch-and-bound nodes explored
+	std::string message;
+	std::vector<MILPtaskresult> tasks;
+	std::vector<int> conflict_tasks;	// positions of the offending tasks (MILP_INVALID, MILP_INFEASIBLE)
+};
+
 #endif
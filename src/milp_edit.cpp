@@ -0,0 +1,426 @@
+#include <string>
+#include <sstream>
+#include <algorithm>
+#include <chrono>
+
+#include "milp_edit.h"
+#include "milp_model.h"
+#include "milp_presolve.h"
+#include "milp_tune.h"
+
+using namespace std;
+
+ILOSTLBEGIN
+
+
+struct WHchainModelImpl {
+	vector<Task> taskchain;
+	vector<WHconstr> inputmk;		// as given
+	vector<WHconstr> setofmk;		// normalized
+	vector<bool> hard;
+	vector<bool> harmonic;
+	OptTarget mytarget;
+	MILPoptions opts;
+
+	IloEnv env;
+	IloModel model;
+	IloCplex cplex;
+	ChainVars vars;
+	unique_ptr<TaskRows> taskrows;
+	IloNumVar OBJ;
+	IloConstraint objrow;
+	bool built;
+
+	// Values of the variables of each task in the last solution (empty: unknown or edited since)
+	vector<vector<double> > start;
+
+	ChainModelInput input() const {
+		ChainModelInput in = { taskchain, setofmk, hard, harmonic, opts };
+		return in;
+	}
+
+	void refresh_flags();
+	bool build();
+	void rebuild_groups(int first, int last);
+	bool rebuild_objective();
+	void forget(int first, int last);
+	void forget_from(int pos);
+};
+
+
+// Variables of task t passed in MIP starts, in a fixed order (the phase of its link is left to CPLEX)
+static void start_vars(const ChainVars &v, const vector<bool> &hard, int t, IloNumVarArray &out)
+{
+	out.add(v.OFFS.at(t));
+	for (int p = 0; p < NUMBER_OF_PATHS; p++) {
+		out.add(v.EFFECTIVEJOB.at(t)[p]);
+		out.add(v.MISSWNEWINPUT.at(t)[p]);
+		out.add(v.MISSAFTEREFFECTIVE.at(t)[p]);
+	}
+	for (int p = 0; p < NUMBER_OF_PATHS - 1; p++) {
+		out.add(v.REDUNDHITS.at(t)[p]);
+		out.add(v.VOIDHITS.at(t)[p]);
+	}
+	if (!hard.at(t)) {
+		for (int p = 0; p < NUMBER_OF_PATHS - 1; p++)
+			out.add(v.boolVOIDJOBS.at(t)[p]);
+		for (int l = 0; l < 2 * NUMBER_OF_PATHS; l++)
+			for (int p = 0; p < 2 * NUMBER_OF_PATHS; p++)
+				out.add(v.boolLENGTHK.at(t)[l][p]);
+	}
+}
+
+
+// A task alone, as validate_chain would see it in any chain
+static bool valid_task(const Task &task, const WHconstr &whc)
+{
+	string message;
+	vector<int> tasks;
+	return validate_chain(vector<Task>(1, task), vector<WHconstr>(1, whc), message, tasks);
+}
+
+
+void WHchainModelImpl::refresh_flags()
+{
+	setofmk = opts.normalize_wh ? normalize_constraints(inputmk) : inputmk;
+
+	hard.assign(taskchain.size(), false);
+	if (opts.hard_presolve)
+		hard = hard_tasks(setofmk);
+
+	harmonic.assign(taskchain.size(), false);
+	if (opts.harmonic_links)
+		harmonic = harmonic_links(taskchain);
+}
+
+
+// False for an unknown target
+bool WHchainModelImpl::build()
+{
+	const int N = taskchain.size();
+	const ChainModelInput in = input();
+
+	model = IloModel(env);
+	taskrows.reset(new TaskRows(model, N));
+
+	for (int t = 0; t < N; t++)
+		add_task_vars(model, in, vars, t);
+	for (int t = 1; t < N; t++)
+		add_link_vars(model, in, vars, t);
+	for (int t = 0; t < N; t++)
+		add_task_rows(in, vars, t, *taskrows);
+
+	OBJ = IloNumVar(env, -INT_MAX, INT_MAX);
+	model.add(OBJ);
+	if (!rebuild_objective())
+		return false;
+	model.add(IloMaximize(env, OBJ));
+
+	cplex.extract(model);
+
+	cplex.setParam(IloCplex::EpGap, opts.epgap);
+	cplex.setParam(IloCplex::TiLim, opts.timelimit);
+	cplex.setParam(IloCplex::Threads, opts.threads);
+	cplex.setParam(IloCplex::MIPEmphasis, opts.mipemphasis);
+	cplex.setParam(IloCplex::HeurFreq, opts.heurfreq);
+	if (opts.random_seed >= 0)
+		cplex.setParam(IloCplex::RandomSeed, opts.random_seed);
+
+	start.assign(N, vector<double>());
+	built = true;
+	return true;
+}
+
+
+// Groups first..last ended and built again, with the phases of their links
+void WHchainModelImpl::rebuild_groups(int first, int last)
+{
+	const ChainModelInput in = input();
+	first = max(first, 0);
+	last = min(last, (int)taskchain.size() - 1);
+
+	for (int t = first; t <= last; t++) {
+		taskrows->clear(t);
+		end_link_vars(vars, t);
+	}
+	for (int t = first; t <= last; t++) {
+		add_link_vars(model, in, vars, t);
+		add_task_rows(in, vars, t, *taskrows);
+	}
+}
+
+
+bool WHchainModelImpl::rebuild_objective()
+{
+	if (objrow.getImpl() != NULL)
+		objrow.end();
+	if (!objective_row(input(), vars, mytarget, OBJ, objrow))
+		return false;
+	model.add(objrow);
+	return true;
+}
+
+
+// Solution values of tasks first..last no longer hold
+void WHchainModelImpl::forget(int first, int last)
+{
+	for (int t = max(first, 0); t <= min(last, (int)start.size() - 1); t++)
+		start.at(t).clear();
+}
+
+
+// Offsets and job indices are anchored at the head (constraint 1): an edit at pos moves those of every
+// task downstream of its producer, only the prefix before pos - 1 keeps its values
+void WHchainModelImpl::forget_from(int pos)
+{
+	forget(pos - 1, (int)start.size() - 1);
+}
+
+
+//-----------------------------------------------------------------------------
+// HANDLE
+//-----------------------------------------------------------------------------
+
+WHchainModel::WHchainModel(const vector<Task> &taskchain, const vector<WHconstr> &setofmk, OptTarget mytarget,
+	const MILPoptions &opts) : impl(new WHchainModelImpl())
+{
+	impl->taskchain = taskchain;
+	impl->inputmk = setofmk;
+	impl->mytarget = mytarget;
+	impl->opts = select_profile(opts, taskchain, setofmk);
+	impl->opts.race = nullptr;
+	impl->built = false;
+
+	impl->env.setOut(impl->opts.verbose ? cout : impl->env.getNullStream());
+	impl->env.setWarning(impl->opts.verbose ? cerr : impl->env.getNullStream());
+	impl->cplex = IloCplex(impl->env);
+	impl->cplex.setOut(impl->opts.verbose ? cout : impl->env.getNullStream());
+}
+
+
+WHchainModel::~WHchainModel()
+{
+	if (impl->taskrows)
+		impl->taskrows->end();
+	impl->cplex.end();
+	impl->env.end();
+}
+
+
+const vector<Task>& WHchainModel::chain() const
+{
+	return impl->taskchain;
+}
+
+
+const vector<WHconstr>& WHchainModel::constraints() const
+{
+	return impl->inputmk;
+}
+
+
+bool WHchainModel::set_timing(int pos, int period, int deadline)
+{
+	WHchainModelImpl &m = *impl;
+	if (pos < 0 || pos >= m.taskchain.size())
+		return false;
+
+	Task task = m.taskchain.at(pos);
+	task.period = period;
+	task.deadline = deadline;
+	if (!valid_task(task, m.inputmk.at(pos)))
+		return false;
+
+	m.taskchain.at(pos) = task;
+	if (!m.built)
+		return true;
+
+	m.refresh_flags();
+	retime_task_vars(m.input(), m.vars, pos);
+
+	// The task and its consumer see the new timing through their links
+	m.rebuild_groups(pos, pos + 1);
+	if (pos == m.taskchain.size() - 1)
+		m.rebuild_objective();
+	m.forget_from(pos);
+
+	return true;
+}
+
+
+bool WHchainModel::insert_task(int pos, const Task &task, const WHconstr &whc)
+{
+	WHchainModelImpl &m = *impl;
+	if (pos < 0 || pos > m.taskchain.size() || !valid_task(task, whc))
+		return false;
+
+	m.taskchain.insert(m.taskchain.begin() + pos, task);
+	m.inputmk.insert(m.inputmk.begin() + pos, whc);
+	if (!m.built)
+		return true;
+
+	m.refresh_flags();
+	add_task_vars(m.model, m.input(), m.vars, pos);
+	m.taskrows->insert(pos);
+
+	// New links on both sides; the previous task may have stopped being the tail
+	m.rebuild_groups(pos - 1, pos + 1);
+	m.rebuild_objective();
+
+	m.start.insert(m.start.begin() + pos, vector<double>());
+	m.forget_from(pos);
+
+	return true;
+}
+
+
+bool WHchainModel::remove_task(int pos)
+{
+	WHchainModelImpl &m = *impl;
+	if (pos < 0 || pos >= m.taskchain.size() || m.taskchain.size() < 2)
+		return false;
+
+	if (m.built) {
+		// Rows on the variables of the task go first: its own group, the link to its consumer, the objective
+		m.taskrows->clear(pos);
+		if (pos + 1 < m.taskchain.size())
+			m.taskrows->clear(pos + 1);
+		m.objrow.end();
+		m.objrow = IloConstraint();
+
+		m.taskrows->erase(pos);
+		end_task_vars(m.vars, pos);
+		m.start.erase(m.start.begin() + pos);
+	}
+
+	m.taskchain.erase(m.taskchain.begin() + pos);
+	m.inputmk.erase(m.inputmk.begin() + pos);
+	if (!m.built)
+		return true;
+
+	m.refresh_flags();
+
+	// The neighbors become linked; the previous task may have become the head or the tail
+	m.rebuild_groups(pos - 1, pos);
+	m.rebuild_objective();
+	m.forget_from(pos);
+
+	return true;
+}
+
+
+MILPresult WHchainModel::solve()
+{
+	auto start_time = chrono::steady_clock::now();
+
+	WHchainModelImpl &m = *impl;
+	MILPresult MILP_out;
+
+	// Malformed or inconsistent inputs never reach the solver
+	if (m.opts.validate && !validate_chain(m.taskchain, m.inputmk, MILP_out.message, MILP_out.conflict_tasks)) {
+		MILP_out.status = MILP_INVALID;
+		if (m.opts.verbose)
+			cerr << MILP_out.message;
+		auto end_time = chrono::steady_clock::now();
+		MILP_out.runtime = chrono::duration<double>(end_time - start_time).count();
+		return MILP_out;
+	}
+
+	try
+	{
+		if (!m.built) {
+			m.refresh_flags();
+			if (!m.build()) {
+				MILP_out.message = "Unknown optimization target";
+				throw(-1);
+			}
+		}
+
+		const ChainModelInput in = m.input();
+		const int N = m.taskchain.size();
+
+		if (m.opts.valid_ineq & VALID_EJ_BOUNDS)
+			set_effective_job_bounds(in, m.vars);
+		if (m.opts.var_names || !m.opts.export_model.empty())
+			name_vars(in, m.vars);
+		if (!m.opts.export_model.empty())
+			m.cplex.exportModel(m.opts.export_model.c_str());
+
+		// Branching priorities of the tasks as they are now
+		set_search_params(m.cplex, in, m.vars);
+
+		IloConstraintArray validcuts = m.taskrows->all_cuts();
+		if (validcuts.getSize() > 0)
+			m.cplex.addUserCuts(validcuts);
+
+		// Previous solution, repaired: tasks away from the edits keep their values and CPLEX completes the rest
+		IloNumVarArray startvars(m.env);
+		IloNumArray startvals(m.env);
+		for (int t = 0; t < N; t++) {
+			if (m.start.at(t).empty())
+				continue;
+			start_vars(m.vars, m.hard, t, startvars);
+			for (int i = 0; i < m.start.at(t).size(); i++)
+				startvals.add(m.start.at(t).at(i));
+		}
+		if (startvars.getSize() > 0)
+			m.cplex.addMIPStart(startvars, startvals, IloCplex::MIPStartSolveMIP);
+		startvars.end();
+		startvals.end();
+
+		bool solved = m.cplex.solve();
+
+		MILP_out.nodes = m.cplex.getNnodes();
+
+		if (validcuts.getSize() > 0)
+			m.cplex.clearUserCuts();
+		validcuts.end();
+		if (m.cplex.getNMIPStarts() > 0)
+			m.cplex.deleteMIPStarts(0, m.cplex.getNMIPStarts());
+
+		if (!solved) {
+			MILP_out.status = failed_status(m.cplex);
+			if (MILP_out.status == MILP_INFEASIBLE && m.opts.refine_conflict)
+				refine_conflict(m.cplex, *m.taskrows, MILP_out);
+			throw(-1);
+		}
+
+		MILP_out.status = (m.cplex.getStatus() == IloAlgorithm::Optimal) ? MILP_OPTIMAL : MILP_FEASIBLE;
+		save_solution(m.cplex, in, m.vars, m.mytarget, m.OBJ, MILP_out);
+
+		if (!m.opts.results_file.empty())
+			write_results_file(m.opts.results_file, m.taskchain, MILP_out);
+
+		// Start of the next solve
+		for (int t = 0; t < N; t++) {
+			IloNumVarArray vars(m.env);
+			IloNumArray vals(m.env);
+			start_vars(m.vars, m.hard, t, vars);
+			m.cplex.getValues(vals, vars);
+			m.start.at(t).assign(vals.getSize(), 0);
+			for (int i = 0; i < vals.getSize(); i++)
+				m.start.at(t).at(i) = vals[i];
+			vars.end();
+			vals.end();
+		}
+	}
+	catch (IloException& e) {
+		std::stringstream msg;
+		msg << "Concert exception caught: " << e;
+		MILP_out.status = MILP_ERROR;
+		MILP_out.message = msg.str();
+	}
+	catch (int) {
+		// Solver did not return a solution, status already set
+		if (MILP_out.message.empty())
+			MILP_out.message = "No solution available";
+	}
+
+	if (m.opts.verbose && !MILP_out.message.empty())
+		cerr << MILP_out.message << endl;
+
+	auto end_time = chrono::steady_clock::now();
+	MILP_out.runtime = chrono::duration<double>(end_time - start_time).count();
+
+	return MILP_out;
+}
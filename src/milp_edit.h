@@ -0,0 +1,54 @@
+#ifndef MILP_EDIT_H__
+#define MILP_EDIT_H__
+
+#include <vector>
+#include <memory>
+
+#include "milp_data.h"
+
+//-----------------------------------------------------------------------------
+// Editable chain model, for what-if analyses
+//
+// The model of a chain is built on the first solve and kept with its solver across local edits:
+// retiming, insertion or removal of one task. An edit of the task at position t touches only the
+// variables of that task and the row groups of tasks t-1 to t+1 (see milp_model.h), plus the
+// objective row; the solver extracts the difference. The next solve is warm-started from the
+// previous solution, repaired: offsets and job indices are anchored at the head, so an edit at t
+// shifts them on every task from t-1 to the tail. Only the values of tasks 0 to t-2 are passed as a
+// partial MIP start, that CPLEX completes on the rest of the chain (no start after an edit of the
+// head or of its consumer).
+//
+// The options are those of MILP_WH_K, except that the model is always built with Concert
+// (bulk_build is ignored), racing is not supported and a tuned profile is chosen for the chain
+// given to the constructor. A handle serves one thread at a time.
+//-----------------------------------------------------------------------------
+
+struct WHchainModelImpl;
+
+class WHchainModel {
+public:
+	WHchainModel(const std::vector<Task> &taskchain, const std::vector<WHconstr> &setofmk, OptTarget mytarget,
+		const MILPoptions &opts);
+	~WHchainModel();
+
+	WHchainModel(const WHchainModel&) = delete;
+	WHchainModel& operator=(const WHchainModel&) = delete;
+
+	// Edits of the chain, positions in the current chain. They return false, leaving the chain
+	// unchanged, for positions out of range, tasks that validate_chain would reject, or the removal
+	// of the last task.
+	bool set_timing(int pos, int period, int deadline);
+	bool insert_task(int pos, const Task &task, const WHconstr &whc);
+	bool remove_task(int pos);
+
+	// Analysis of the current chain
+	MILPresult solve();
+
+	const std::vector<Task>& chain() const;
+	const std::vector<WHconstr>& constraints() const;
+
+private:
+	std::unique_ptr<WHchainModelImpl> impl;
+};
+
+#endif
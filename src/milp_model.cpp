@@ -0,0 +1,892 @@
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <climits>
+#include <cstdint>
+#include <cmath>
+
+#include "milp_model.h"
+#include "milp_WHchain.h"
+#include "milp_presolve.h"
+
+#define TOL 0.001
+#define TOL_OFFS 0.001
+
+using namespace std;
+
+ILOSTLBEGIN
+
+
+//-----------------------------------------------------------------------------
+// ROW GROUPS
+//-----------------------------------------------------------------------------
+
+TaskRows::TaskRows(IloModel model, int num_tasks) : model(model)
+{
+	for (int t = 0; t < num_tasks; t++) {
+		rows.push_back(IloConstraintArray(model.getEnv()));
+		cuts.push_back(IloConstraintArray(model.getEnv()));
+	}
+}
+
+
+void TaskRows::add(int t, const IloConstraint &c)
+{
+	model.add(c);
+	rows.at(t).add(c);
+}
+
+
+void TaskRows::cut(int t, const IloConstraint &c)
+{
+	cuts.at(t).add(c);
+}
+
+
+void TaskRows::insert(int t)
+{
+	rows.insert(rows.begin() + t, IloConstraintArray(model.getEnv()));
+	cuts.insert(cuts.begin() + t, IloConstraintArray(model.getEnv()));
+}
+
+
+void TaskRows::clear(int t)
+{
+	rows.at(t).endElements();
+	rows.at(t).clear();
+	cuts.at(t).endElements();
+	cuts.at(t).clear();
+}
+
+
+void TaskRows::erase(int t)
+{
+	clear(t);
+	rows.at(t).end();
+	cuts.at(t).end();
+	rows.erase(rows.begin() + t);
+	cuts.erase(cuts.begin() + t);
+}
+
+
+IloConstraintArray TaskRows::all_cuts() const
+{
+	IloConstraintArray all(model.getEnv());
+	for (int t = 0; t < cuts.size(); t++)
+		for (int i = 0; i < cuts.at(t).getSize(); i++)
+			all.add(cuts.at(t)[i]);
+	return all;
+}
+
+
+void TaskRows::end()
+{
+	for (int t = 0; t < rows.size(); t++) {
+		rows.at(t).end();
+		cuts.at(t).endElements();
+		cuts.at(t).end();
+	}
+	rows.clear();
+	cuts.clear();
+}
+
+
+//-----------------------------------------------------------------------------
+// VARIABLES
+//-----------------------------------------------------------------------------
+
+void add_task_vars(IloModel model, const ChainModelInput &in, ChainVars &v, int t)
+{
+	IloEnv env = model.getEnv();
+	const int T = in.taskchain.at(t).period;
+	const bool hard = in.hard.at(t);
+
+	// Release offset of a task
+	IloNumVar OFFS(env, 0.0, T - TOL_OFFS);
+
+	// Index of effective job
+	IloIntVarArray EFFECTIVEJOB(env, NUMBER_OF_PATHS);
+	for (unsigned int l = 0; l < NUMBER_OF_PATHS; l++)
+		EFFECTIVEJOB[l] = IloIntVar(env, 0.0, UINT16_MAX);
+
+	// Number of redundant jobs until a new input is available (R jobs)
+	IloIntVarArray REDUNDHITS(env, NUMBER_OF_PATHS - 1);
+	for (unsigned int l = 0; l < NUMBER_OF_PATHS - 1; l++)
+		REDUNDHITS[l] = IloIntVar(env, 0.0, UINT16_MAX);
+
+	// Number of missed jobs after the first input overwrite (M1 jobs)
+	IloIntVarArray MISSWNEWINPUT(env, NUMBER_OF_PATHS);
+	for (unsigned int l = 0; l < NUMBER_OF_PATHS; l++)
+		MISSWNEWINPUT[l] = IloIntVar(env, 0.0, hard ? 0.0 : UINT16_MAX);
+
+	// Number of V jobs
+	IloIntVarArray VOIDHITS(env, NUMBER_OF_PATHS - 1);
+	for (unsigned int l = 0; l < NUMBER_OF_PATHS - 1; l++)
+		VOIDHITS[l] = IloIntVar(env, 0.0, UINT16_MAX);
+
+	// Number of missed jobs after completion of next effective job of producer task (M2 jobs)
+	IloIntVarArray MISSAFTEREFFECTIVE(env, NUMBER_OF_PATHS);
+	for (unsigned int l = 0; l < NUMBER_OF_PATHS; l++)
+		MISSAFTEREFFECTIVE[l] = IloIntVar(env, 0.0, hard ? 0.0 : UINT16_MAX);
+
+	// Auxiliary variable: there is at least one V job of task t between the jobs of paths p and p+1
+	// (only needed by weakly-hard tasks: see constraints 4 and 6)
+	IloIntVarArray boolVOIDJOBS(env, hard ? 0 : NUMBER_OF_PATHS - 1);
+	for (unsigned int l = 0; l < boolVOIDJOBS.getSize(); l++)
+		boolVOIDJOBS[l] = IloIntVar(env, 0.0, 1.0);
+
+	// Auxiliary variable: length of subsequence between two blocks of misses is <= k
+	// (only needed by weakly-hard tasks)
+	IntVarMatrix boolLENGTHK(env, 0);
+	if (!hard) {
+		boolLENGTHK = IntVarMatrix(env, 2 * NUMBER_OF_PATHS);
+		for (unsigned int l = 0; l < 2 * NUMBER_OF_PATHS; l++) {
+			boolLENGTHK[l] = IloIntVarArray(env, 2 * NUMBER_OF_PATHS);
+			for (unsigned int p = 0; p < 2 * NUMBER_OF_PATHS; p++)
+				boolLENGTHK[l][p] = IloIntVar(env, 0.0, 1.0);
+		}
+	}
+
+	// Variables belong to the model, so that they are released with it
+	model.add(OFFS);
+	model.add(EFFECTIVEJOB);
+	model.add(REDUNDHITS);
+	model.add(MISSWNEWINPUT);
+	model.add(VOIDHITS);
+	model.add(MISSAFTEREFFECTIVE);
+	model.add(boolVOIDJOBS);
+	if (!hard) {
+		for (unsigned int l = 0; l < 2 * NUMBER_OF_PATHS; l++)
+			model.add(boolLENGTHK[l]);
+	}
+
+	v.OFFS.insert(v.OFFS.begin() + t, OFFS);
+	v.EFFECTIVEJOB.insert(v.EFFECTIVEJOB.begin() + t, EFFECTIVEJOB);
+	v.REDUNDHITS.insert(v.REDUNDHITS.begin() + t, REDUNDHITS);
+	v.MISSWNEWINPUT.insert(v.MISSWNEWINPUT.begin() + t, MISSWNEWINPUT);
+	v.VOIDHITS.insert(v.VOIDHITS.begin() + t, VOIDHITS);
+	v.MISSAFTEREFFECTIVE.insert(v.MISSAFTEREFFECTIVE.begin() + t, MISSAFTEREFFECTIVE);
+	v.boolVOIDJOBS.insert(v.boolVOIDJOBS.begin() + t, boolVOIDJOBS);
+	v.boolLENGTHK.insert(v.boolLENGTHK.begin() + t, boolLENGTHK);
+	v.PHASE.insert(v.PHASE.begin() + t, IloNumVar());
+	v.has_phase.insert(v.has_phase.begin() + t, false);
+}
+
+
+void end_task_vars(ChainVars &v, int t)
+{
+	end_link_vars(v, t);
+
+	v.OFFS.at(t).end();
+	v.EFFECTIVEJOB.at(t).endElements();
+	v.EFFECTIVEJOB.at(t).end();
+	v.REDUNDHITS.at(t).endElements();
+	v.REDUNDHITS.at(t).end();
+	v.MISSWNEWINPUT.at(t).endElements();
+	v.MISSWNEWINPUT.at(t).end();
+	v.VOIDHITS.at(t).endElements();
+	v.VOIDHITS.at(t).end();
+	v.MISSAFTEREFFECTIVE.at(t).endElements();
+	v.MISSAFTEREFFECTIVE.at(t).end();
+	v.boolVOIDJOBS.at(t).endElements();
+	v.boolVOIDJOBS.at(t).end();
+	if (v.boolLENGTHK.at(t).getSize() > 0) {
+		for (int l = 0; l < v.boolLENGTHK.at(t).getSize(); l++) {
+			v.boolLENGTHK.at(t)[l].endElements();
+			v.boolLENGTHK.at(t)[l].end();
+		}
+		v.boolLENGTHK.at(t).end();
+	}
+
+	v.OFFS.erase(v.OFFS.begin() + t);
+	v.EFFECTIVEJOB.erase(v.EFFECTIVEJOB.begin() + t);
+	v.REDUNDHITS.erase(v.REDUNDHITS.begin() + t);
+	v.MISSWNEWINPUT.erase(v.MISSWNEWINPUT.begin() + t);
+	v.VOIDHITS.erase(v.VOIDHITS.begin() + t);
+	v.MISSAFTEREFFECTIVE.erase(v.MISSAFTEREFFECTIVE.begin() + t);
+	v.boolVOIDJOBS.erase(v.boolVOIDJOBS.begin() + t);
+	v.boolLENGTHK.erase(v.boolLENGTHK.begin() + t);
+	v.PHASE.erase(v.PHASE.begin() + t);
+	v.has_phase.erase(v.has_phase.begin() + t);
+}
+
+
+void retime_task_vars(const ChainModelInput &in, ChainVars &v, int t)
+{
+	v.OFFS.at(t).setUB(in.taskchain.at(t).period - TOL_OFFS);
+}
+
+
+void add_link_vars(IloModel model, const ChainModelInput &in, ChainVars &v, int t)
+{
+	// Phase of a harmonic link, between completion of a producer job and next activation of the consumer
+	if (t == 0 || !in.harmonic.at(t) || v.has_phase.at(t))
+		return;
+
+	int T = in.taskchain.at(t).period;
+	v.PHASE.at(t) = IloNumVar(model.getEnv(), 0.0, T * (1 - TOL));
+	v.has_phase.at(t) = true;
+	model.add(v.PHASE.at(t));
+}
+
+
+void end_link_vars(ChainVars &v, int t)
+{
+	if (!v.has_phase.at(t))
+		return;
+
+	v.PHASE.at(t).end();
+	v.PHASE.at(t) = IloNumVar();
+	v.has_phase.at(t) = false;
+}
+
+
+void name_vars(const ChainModelInput &in, ChainVars &v)
+{
+	for (int t = 0; t < v.OFFS.size(); t++) {
+		string tn = convert_to_string(t);
+		v.OFFS[t].setName(("OFFS" + tn).c_str());
+		for (int l = 0; l < NUMBER_OF_PATHS; l++) {
+			string ln = tn + convert_to_string(l);
+			v.EFFECTIVEJOB[t][l].setName(("EID" + ln).c_str());
+			v.MISSWNEWINPUT[t][l].setName(("nMISSni" + ln).c_str());
+			v.MISSAFTEREFFECTIVE[t][l].setName(("nMISSV" + ln).c_str());
+		}
+		for (int l = 0; l < NUMBER_OF_PATHS - 1; l++) {
+			string ln = tn + convert_to_string(l);
+			v.REDUNDHITS[t][l].setName(("nRED" + ln).c_str());
+			v.VOIDHITS[t][l].setName(("nINC" + ln).c_str());
+			if (!in.hard.at(t))
+				v.boolVOIDJOBS[t][l].setName(("boolHV" + ln).c_str());
+		}
+		if (!in.hard.at(t)) {
+			for (int l = 0; l < 2 * NUMBER_OF_PATHS; l++)
+				for (int p = 0; p < 2 * NUMBER_OF_PATHS; p++)
+					v.boolLENGTHK[t][l][p].setName(("boolLEN" + tn + convert_to_string(l) + convert_to_string(p)).c_str());
+		}
+		if (v.has_phase.at(t))
+			v.PHASE[t].setName(("PHASE" + tn).c_str());
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// ROWS
+//-----------------------------------------------------------------------------
+
+void add_task_rows(const ChainModelInput &in, const ChainVars &v, int t, TaskRows &taskrows)
+{
+	const vector<Task> &taskchain = in.taskchain;
+	const vector<WHconstr> &setofmk = in.setofmk;
+	const vector<bool> &hard = in.hard;
+	const vector<bool> &harmonic = in.harmonic;
+	const MILPoptions &opts = in.opts;
+
+	const vector<IloNumVar> &OFFS = v.OFFS;
+	const vector<IloIntVarArray> &EFFECTIVEJOB = v.EFFECTIVEJOB;
+	const vector<IloIntVarArray> &REDUNDHITS = v.REDUNDHITS;
+	const vector<IloIntVarArray> &MISSWNEWINPUT = v.MISSWNEWINPUT;
+	const vector<IloIntVarArray> &VOIDHITS = v.VOIDHITS;
+	const vector<IloIntVarArray> &MISSAFTEREFFECTIVE = v.MISSAFTEREFFECTIVE;
+	const vector<IloIntVarArray> &boolVOIDJOBS = v.boolVOIDJOBS;
+	const vector<IntVarMatrix> &boolLENGTHK = v.boolLENGTHK;
+	const vector<IloNumVar> &PHASE = v.PHASE;
+
+	IloEnv env = taskrows.model.getEnv();
+
+	// Number of tasks in a chain
+	const int NUMBER_OF_TASKS_IN_CHAIN = taskchain.size();
+
+	// Big-M (to represent infinity)
+	const double BIGM = INT_MAX;
+
+	const int Tt = taskchain.at(t).period;
+	const int Tt1 = (t > 0) ? taskchain.at(t - 1).period : 0;
+	const int Dt1 = (t > 0) ? taskchain.at(t - 1).deadline : 0;
+
+	//----------------------------------------------------------------------------
+	// CONSTRAINT 1
+	// Constraining variables for head task of the chain
+	if (t == 0) {
+		// Offset of head task is 0
+		taskrows.add(0, OFFS[0] == 0);
+		// First effective job of head task has index 0
+		taskrows.add(0, EFFECTIVEJOB[0][0] == 0);
+	}
+
+
+	//----------------------------------------------------------------------------
+	// CONSTRAINT 2
+	// Encoded in definition of OFFS
+
+
+	//----------------------------------------------------------------------------
+	// CONSTRAINT 3
+	if (t == 0) {
+		// Head task cannot have redundant jobs
+		// (open head: the head has an unknown producer, so it may have redundant jobs and misses)
+		if (!opts.open_head) {
+			for (int p = 0; p < NUMBER_OF_PATHS - 1; p++) {
+				taskrows.add(0, REDUNDHITS[0][p] == 0);
+			}
+			// Head task cannot have "misses after effective job of producer task" (it has no producer!)
+			for (int p = 0; p < NUMBER_OF_PATHS; p++) {
+				taskrows.add(0, MISSAFTEREFFECTIVE[0][p] == 0);
+			}
+		}
+		// Bound on the jobs of the head between two paths, known from the analysis of its producer
+		if (opts.head_max_gap > 0) {
+			for (int p = 0; p < NUMBER_OF_PATHS - 1; p++) {
+				taskrows.add(0, EFFECTIVEJOB[0][p + 1] - EFFECTIVEJOB[0][p] <= opts.head_max_gap);
+			}
+		}
+	}
+	// Tail task cannot have void jobs
+	// (open tail: the tail has an unknown consumer)
+	if (t == NUMBER_OF_TASKS_IN_CHAIN - 1 && !opts.open_tail) {
+		for (int p = 0; p < NUMBER_OF_PATHS - 1; p++) {
+			taskrows.add(t, VOIDHITS[t][p] == 0);
+			if (!hard.at(t))
+				taskrows.add(t, boolVOIDJOBS[t][p] == 0);
+		}
+	}
+
+
+	//----------------------------------------------------------------------------
+	// CONSTRAINT 4
+	// Checking if there exist void hits at level of task t
+	// Note that task tail cannot have void hits (unless the tail is open)
+	// (hard tasks: boolVOIDJOBS would only appear here, as constraint 6 is dropped for hard producers)
+	const int LAST_WITH_VOID = opts.open_tail ? NUMBER_OF_TASKS_IN_CHAIN : NUMBER_OF_TASKS_IN_CHAIN - 1;
+	if (t < LAST_WITH_VOID && !hard.at(t)) {
+		for (int p = 0; p < NUMBER_OF_PATHS - 1; p++) {
+			taskrows.add(t, VOIDHITS[t][p] <= boolVOIDJOBS[t][p] * BIGM);
+			taskrows.add(t, VOIDHITS[t][p] >= boolVOIDJOBS[t][p]);
+		}
+	}
+
+
+	if (t > 0) {
+
+		//----------------------------------------------------------------------------
+		// CONSTRAINT 5
+		// Effective job of i-th task of the chain must start before the
+		// next hit job of (i-1)th task of the chain completes with a different output
+		for (int p = 0; p < NUMBER_OF_PATHS - 1; p++) {
+
+			// The activation of EFFECTIVEJOB_tp occurs after (or at) the completion of EFFECTIVEJOB_(t-1)p
+			// (harmonic links: implied by constraint 8)
+			if (!harmonic.at(t))
+				taskrows.add(t, OFFS[t] + Tt * EFFECTIVEJOB[t][p] >=
+					OFFS[t - 1] + Tt1 * EFFECTIVEJOB[t - 1][p] + Dt1);
+
+			// The activation of EFFECTIVEJOB_tp occurs before the completion of EFFECTIVEJOB_(t-1)(p+1)
+			taskrows.add(t, OFFS[t] + Tt * EFFECTIVEJOB[t][p] <=
+				OFFS[t - 1] + Tt1 * EFFECTIVEJOB[t - 1][p + 1] + Dt1 - TOL);
+		}
+
+
+		//----------------------------------------------------------------------------
+		// CONSTRAINT 6
+		// Between the end of the effective job of task t-1 of path p, and the beginning of the
+		// effective job of task t of the same path p, task t-1 cannot have INCOMPLHITS
+		// (hard producers: implied by the first row of constraint 7, as REDUNDHITS_tp >= 0)
+		for (int p = 0; p < NUMBER_OF_PATHS - 1 && !hard.at(t - 1); p++) {
+			taskrows.add(t, OFFS[t - 1] + (EFFECTIVEJOB[t - 1][p] + REDUNDHITS[t - 1][p]
+				+ MISSWNEWINPUT[t - 1][p] + 1) * Tt1 + Dt1 - TOL >=
+				OFFS[t] + EFFECTIVEJOB[t][p] * Tt - (1 - boolVOIDJOBS[t - 1][p]) * BIGM);
+		}
+
+
+		//----------------------------------------------------------------------------
+		// CONSTRAINT 7
+		// A task t may have redundant hits after a effective job, until task t-1 has produced a new output
+		// Head task has no redundant hits (already defined above)
+		for (int p = 0; p < NUMBER_OF_PATHS - 1; p++) {
+
+			// The activation of the last redundant hit must occur before the end of the first job of
+			// producer task that works on new data and that successfully completes
+			if (hard.at(t - 1)) {
+				// Producer never misses: both cases collapse to the next job of the producer
+				taskrows.add(t, OFFS[t] + Tt * (EFFECTIVEJOB[t][p] + REDUNDHITS[t][p]) <=
+					OFFS[t - 1] + Tt1 * (EFFECTIVEJOB[t - 1][p] + REDUNDHITS[t - 1][p] + 1)
+					+ Dt1 - TOL);
+				continue;
+			}
+
+			taskrows.add(t, OFFS[t] + Tt * (EFFECTIVEJOB[t][p] + REDUNDHITS[t][p]) <=
+				OFFS[t - 1] + Tt1 * (EFFECTIVEJOB[t - 1][p] + REDUNDHITS[t - 1][p]
+					+ MISSWNEWINPUT[t - 1][p] + 1)
+				+ Dt1 - TOL + (1 - boolVOIDJOBS[t - 1][p]) * BIGM);
+
+			taskrows.add(t, OFFS[t] + Tt * (EFFECTIVEJOB[t][p] + REDUNDHITS[t][p]) <=
+				OFFS[t - 1] + Tt1 * (EFFECTIVEJOB[t - 1][p] + REDUNDHITS[t - 1][p]
+					+ MISSWNEWINPUT[t - 1][p] + MISSAFTEREFFECTIVE[t - 1][p + 1] + 1)
+				+ Dt1 - TOL + boolVOIDJOBS[t - 1][p] * BIGM);
+		}
+
+
+		//----------------------------------------------------------------------------
+		// CONSTRAINT 8
+		// Between the end of the effective job of task t-1 of path p, and the beginning of the
+		// effective job of task t of the same path p, task t may miss MISSAFTEREFFECTIVE jobs
+		for (int p = 0; p < NUMBER_OF_PATHS; p++) {
+
+			// Harmonic link: the distance between the end of EFFECTIVEJOB_(t-1)p and the activation of
+			// EFFECTIVEJOB_tp is MISSAFTEREFFECTIVE_tp periods plus a phase that is the same for all paths
+			if (harmonic.at(t)) {
+				taskrows.add(t, OFFS[t] + Tt * (EFFECTIVEJOB[t][p] - MISSAFTEREFFECTIVE[t][p]) ==
+					OFFS[t - 1] + Tt1 * EFFECTIVEJOB[t - 1][p] + Dt1 + PHASE[t]);
+				continue;
+			}
+
+			// floor function of the number of instances of task t between the end of
+			// EFFECTIVEJOB_(t-1)p and the activation of EFFECTIVEJOB_tp
+			taskrows.add(t, MISSAFTEREFFECTIVE[t][p] >=
+				(OFFS[t] + EFFECTIVEJOB[t][p] * Tt -
+				(OFFS[t - 1] + EFFECTIVEJOB[t - 1][p] * Tt1 + Dt1)) / Tt - 1 + TOL);
+
+			taskrows.add(t, MISSAFTEREFFECTIVE[t][p] <=
+				(OFFS[t] + EFFECTIVEJOB[t][p] * Tt -
+				(OFFS[t - 1] + EFFECTIVEJOB[t - 1][p] * Tt1 + Dt1)) / Tt);
+		}
+	}
+
+
+	//----------------------------------------------------------------------------
+	// CONSTRAINT 9
+	// The index of the effective job of path p+1 is equal to the index of the effective job of path p
+	// plus REDUNDHITS + MISSWNEWINPUT + VOIDHITS + MISSAFTEREFFECTIVE + 1
+	for (int p = 0; p < NUMBER_OF_PATHS - 1; p++) {
+		taskrows.add(t, EFFECTIVEJOB[t][p + 1] ==
+			EFFECTIVEJOB[t][p] + REDUNDHITS[t][p] + MISSWNEWINPUT[t][p]
+			+ VOIDHITS[t][p] + MISSAFTEREFFECTIVE[t][p + 1] + 1);
+	}
+
+	// Index of effective job of path p+1 is greater than index of effective job of path p
+	for (int p = 0; p < NUMBER_OF_PATHS - 1; p++) {
+		taskrows.add(t, EFFECTIVEJOB[t][p + 1] >= 1 + EFFECTIVEJOB[t][p]);
+	}
+
+
+	if (!hard.at(t)) {
+
+		//----------------------------------------------------------------------------
+		// CONSTRAINT 10
+		// A task cannot miss more than m_consec misses
+		// (hard tasks: encoded in the bounds of the miss counters, as for constraints 11-13)
+		for (int p = 0; p < NUMBER_OF_PATHS - 1; p++) {
+			taskrows.add(t, MISSWNEWINPUT[t][p] <= setofmk.at(t).mconsec);
+			taskrows.add(t, MISSAFTEREFFECTIVE[t][p] <= setofmk.at(t).mconsec);
+		}
+		taskrows.add(t, MISSAFTEREFFECTIVE[t][NUMBER_OF_PATHS - 1] <= setofmk.at(t).mconsec);
+
+
+		//----------------------------------------------------------------------------
+		// CONSTRAINT 11
+		// If there are no void jobs, MISSWNEWINPUT and MISSAFTEREFFECTIVE occur side by side
+		// thus mconsec must be enforced for the whole sequence
+		for (int p = 0; p < NUMBER_OF_PATHS - 1; p++) {
+			taskrows.add(t, MISSWNEWINPUT[t][p] + MISSAFTEREFFECTIVE[t][p + 1] <=
+				setofmk.at(t).mconsec + boolVOIDJOBS[t][p] * BIGM);
+		}
+
+
+		//----------------------------------------------------------------------------
+		// CONSTRAINT 12 & CONSTRAINT 13
+		// Miss and hit patterns must satisfy also the (m,k) constraints
+
+		// Checking sequences starting from MISSAFTEREFFECTIVE
+		for (int s = 0; s < NUMBER_OF_PATHS - 1; s++) {
+
+			IloExpr LENGTHSEQ(env);
+			IloExpr NUMMISSES(env);
+
+			LENGTHSEQ += MISSAFTEREFFECTIVE[t][s];
+			NUMMISSES += MISSAFTEREFFECTIVE[t][s];
+
+			for (int p = s; p < NUMBER_OF_PATHS - 1; p++) {
+
+				// Check until MISSNEWINPUT
+				LENGTHSEQ += 1 + REDUNDHITS[t][p] + MISSWNEWINPUT[t][p];
+				NUMMISSES += MISSWNEWINPUT[t][p];
+
+				for (int i = 0; i < setofmk.at(t).mk.size(); i++) {
+
+					int m = setofmk.at(t).mk.at(i).m;
+					int k = setofmk.at(t).mk.at(i).k;
+
+					taskrows.add(t, LENGTHSEQ <= k + (1 - boolLENGTHK[t][2 * s][2 * p]) * BIGM);
+					taskrows.add(t, LENGTHSEQ >= k + 1 - boolLENGTHK[t][2 * s][2 * p] * BIGM);
+
+					// Adding necessary and sufficient constraints to check (m,k)
+					taskrows.add(t, NUMMISSES <= m + (1 - boolLENGTHK[t][2 * s][2 * p]) * BIGM);
+					taskrows.add(t, LENGTHSEQ - NUMMISSES >= k - m - boolLENGTHK[t][2 * s][2 * p] * BIGM);
+				}
+
+				// Continue checking until MISSAFTEREFFECTIVE
+				LENGTHSEQ += VOIDHITS[t][p] + MISSAFTEREFFECTIVE[t][p + 1];
+				NUMMISSES += MISSAFTEREFFECTIVE[t][p + 1];
+
+				for (int i = 0; i < setofmk.at(t).mk.size(); i++) {
+
+					int m = setofmk.at(t).mk.at(i).m;
+					int k = setofmk.at(t).mk.at(i).k;
+
+					taskrows.add(t, LENGTHSEQ <= k + (1 - boolLENGTHK[t][2 * s][2 * p + 1]) * BIGM);
+					taskrows.add(t, LENGTHSEQ >= k + 1 - boolLENGTHK[t][2 * s][2 * p + 1] * BIGM);
+
+					// Adding necessary and sufficient constraints to check (m,k)
+					taskrows.add(t, NUMMISSES <= m + (1 - boolLENGTHK[t][2 * s][2 * p + 1]) * BIGM);
+					taskrows.add(t, LENGTHSEQ - NUMMISSES >= k - m - boolLENGTHK[t][2 * s][2 * p + 1] * BIGM);
+				}
+			}
+
+			LENGTHSEQ.end();
+			NUMMISSES.end();
+		}
+
+		// Checking sequences starting from MISSNEWINPUT
+		for (int s = 0; s < NUMBER_OF_PATHS - 1; s++) {
+
+			IloExpr LENGTHSEQ(env);
+			IloExpr NUMMISSES(env);
+
+			LENGTHSEQ += MISSWNEWINPUT[t][s];
+			NUMMISSES += MISSWNEWINPUT[t][s];
+
+			for (int p = s; p < NUMBER_OF_PATHS - 1; p++) {
+
+				// Check until MISSAFTEREFFECTIVE
+				LENGTHSEQ += VOIDHITS[t][p] + MISSAFTEREFFECTIVE[t][p + 1];
+				NUMMISSES += MISSAFTEREFFECTIVE[t][p + 1];
+
+				for (int i = 0; i < setofmk.at(t).mk.size(); i++) {
+
+					int m = setofmk.at(t).mk.at(i).m;
+					int k = setofmk.at(t).mk.at(i).k;
+
+					taskrows.add(t, LENGTHSEQ <= k + (1 - boolLENGTHK[t][2 * s + 1][2 * p]) * BIGM);
+					taskrows.add(t, LENGTHSEQ >= k + 1 - boolLENGTHK[t][2 * s + 1][2 * p] * BIGM);
+
+					// Adding necessary and sufficient constraints to check (m,k)
+					taskrows.add(t, NUMMISSES <= m + (1 - boolLENGTHK[t][2 * s + 1][2 * p]) * BIGM);
+					taskrows.add(t, LENGTHSEQ - NUMMISSES >= k - m - boolLENGTHK[t][2 * s + 1][2 * p] * BIGM);
+				}
+
+				if (p < NUMBER_OF_PATHS - 2) {
+					// Check until MISSNEWINPUT
+					LENGTHSEQ += 1 + REDUNDHITS[t][p+1] + MISSWNEWINPUT[t][p+1];
+					NUMMISSES += MISSWNEWINPUT[t][p+1];
+
+					for (int i = 0; i < setofmk.at(t).mk.size(); i++) {
+
+						int m = setofmk.at(t).mk.at(i).m;
+						int k = setofmk.at(t).mk.at(i).k;
+
+						taskrows.add(t, LENGTHSEQ <= k + (1 - boolLENGTHK[t][2 * s + 1][2 * p + 1]) * BIGM);
+						taskrows.add(t, LENGTHSEQ >= k + 1 - boolLENGTHK[t][2 * s + 1][2 * p + 1] * BIGM);
+
+						// Adding necessary and sufficient constraints to check (m,k)
+						taskrows.add(t, NUMMISSES <= m + (1 - boolLENGTHK[t][2 * s + 1][2 * p + 1]) * BIGM);
+						taskrows.add(t, LENGTHSEQ - NUMMISSES >= k - m - boolLENGTHK[t][2 * s + 1][2 * p + 1] * BIGM);
+					}
+				}
+			}
+
+			LENGTHSEQ.end();
+			NUMMISSES.end();
+		}
+	}
+
+
+	//----------------------------------------------------------------------------
+	// VALID INEQUALITIES
+	// Implied by constraints 1-13 on integer solutions, they only tighten the LP relaxation.
+	// Offsets need no symmetry breaking: constraint 1 and the ranges of OFFS already fix the time origin.
+	if (t == 0)
+		return;
+
+	const int g = period_gcd(Tt, Tt1);
+
+	// Gaps of adjacent tasks between two paths. From constraint 8 (and 5), for X = EJ_tp+1 - EJ_tp
+	// - MISSAFTEREFFECTIVE_tp+1 + MISSAFTEREFFECTIVE_tp: Tt (X - 1) < Tt1 (EJ_t-1p+1 - EJ_t-1p) < Tt (X + 1),
+	// rounded over the integers after division by gcd(Tt, Tt1). Harmonic links: equality already in the model.
+	if ((opts.valid_ineq & VALID_EJ_RATIO) && !harmonic.at(t)) {
+		int a = Tt / g;
+		int b = Tt1 / g;
+
+		for (int p = 0; p < NUMBER_OF_PATHS - 1; p++) {
+			IloExpr X = EFFECTIVEJOB[t][p + 1] - EFFECTIVEJOB[t][p]
+				- MISSAFTEREFFECTIVE[t][p + 1] + MISSAFTEREFFECTIVE[t][p];
+			IloExpr GAP = EFFECTIVEJOB[t - 1][p + 1] - EFFECTIVEJOB[t - 1][p];
+
+			IloConstraint upper = (a * (X - 1) - b * GAP <= -1);
+			IloConstraint lower = (a * (X + 1) - b * GAP >= 1);
+			if (opts.valid_as_cuts) {
+				taskrows.cut(t, upper);
+				taskrows.cut(t, lower);
+			}
+			else {
+				taskrows.add(t, upper);
+				taskrows.add(t, lower);
+			}
+
+			X.end();
+			GAP.end();
+		}
+	}
+
+	// Constraint 7 holds with the looser of its two right-hand sides whatever boolVOIDJOBS is, and
+	// again after the completion of EFFECTIVEJOB_(t-1)p is subtracted (rounded as above)
+	if (opts.valid_ineq & VALID_REDUND_COUPLING) {
+		for (int p = 0; p < NUMBER_OF_PATHS - 1; p++) {
+			IloExpr PRODUCED = REDUNDHITS[t - 1][p] + MISSWNEWINPUT[t - 1][p] + MISSAFTEREFFECTIVE[t - 1][p + 1];
+
+			vector<IloConstraint> rows;
+			// (hard producers: already in the model)
+			if (!hard.at(t - 1))
+				rows.push_back(OFFS[t] + Tt * (EFFECTIVEJOB[t][p] + REDUNDHITS[t][p]) <=
+					OFFS[t - 1] + Tt1 * (EFFECTIVEJOB[t - 1][p] + PRODUCED + 1) + Dt1 - TOL);
+			rows.push_back((Tt / g) * (REDUNDHITS[t][p] + MISSAFTEREFFECTIVE[t][p]) - (Tt1 / g) * PRODUCED
+				<= Tt1 / g - 1);
+
+			for (int i = 0; i < rows.size(); i++) {
+				if (opts.valid_as_cuts)
+					taskrows.cut(t, rows.at(i));
+				else
+					taskrows.add(t, rows.at(i));
+			}
+
+			PRODUCED.end();
+		}
+	}
+}
+
+
+void set_effective_job_bounds(const ChainModelInput &in, ChainVars &v)
+{
+	const int N = in.taskchain.size();
+
+	// Range of the first effective job, from the shortest and longest admissible latencies
+	const bool bounds = (in.opts.valid_ineq & VALID_EJ_BOUNDS);
+	vector<int> lo, hi;
+	if (bounds)
+		first_effective_job_bounds(in.taskchain, in.setofmk, in.hard, lo, hi);
+
+	for (int t = 1; t < N; t++) {
+		for (int p = 0; p < NUMBER_OF_PATHS; p++)
+			v.EFFECTIVEJOB[t][p].setBounds(bounds ? lo.at(t) + p : 0, UINT16_MAX);
+		if (bounds)
+			v.EFFECTIVEJOB[t][0].setUB(hi.at(t));
+	}
+}
+
+
+bool objective_row(const ChainModelInput &in, const ChainVars &v, OptTarget mytarget, IloNumVar OBJ, IloConstraint &row)
+{
+	const vector<IloNumVar> &OFFS = v.OFFS;
+	const vector<IloIntVarArray> &EFFECTIVEJOB = v.EFFECTIVEJOB;
+
+	int tailtask_id = in.taskchain.size() - 1;
+	int Tt = in.taskchain.at(tailtask_id).period;
+	int Dt = in.taskchain.at(tailtask_id).deadline;
+
+	switch (mytarget) {
+
+	case MAXIMIZE_LATENCY: // Maximize end-to-end latency of effective path
+		row = (OBJ <= OFFS[tailtask_id] + EFFECTIVEJOB[tailtask_id][0] * Tt + Dt);
+		return true;
+
+	case MAXIMIZE_DATAAGE: // Maximize data age
+		row = (OBJ <= OFFS[tailtask_id] + EFFECTIVEJOB[tailtask_id][1] * Tt);
+		return true;
+
+	case MAXIMIZE_UPDATE_INT: // Maximize update interval
+		row = (OBJ <= (EFFECTIVEJOB[tailtask_id][1] - EFFECTIVEJOB[tailtask_id][0]) * Tt);
+		return true;
+
+	case MINIMIZE_UPDATE_INT: // Minimize update interval
+		row = (OBJ <= -(EFFECTIVEJOB[tailtask_id][1] - EFFECTIVEJOB[tailtask_id][0]) * Tt);
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// SOLVER
+//-----------------------------------------------------------------------------
+
+void set_search_params(IloCplex cplex, const ChainModelInput &in, const ChainVars &v)
+{
+	const MILPoptions &opts = in.opts;
+	const int NUMBER_OF_TASKS_IN_CHAIN = in.taskchain.size();
+
+	if (opts.cuts != 0) {
+		cplex.setParam(IloCplex::MIRCuts, opts.cuts);
+		cplex.setParam(IloCplex::FlowCovers, opts.cuts);
+		cplex.setParam(IloCplex::Cliques, opts.cuts);
+		cplex.setParam(IloCplex::Covers, opts.cuts);
+		cplex.setParam(IloCplex::GUBCovers, opts.cuts);
+		cplex.setParam(IloCplex::ImplBd, opts.cuts);
+		cplex.setParam(IloCplex::FracCuts, opts.cuts);
+		cplex.setParam(IloCplex::DisjCuts, opts.cuts);
+		cplex.setParam(IloCplex::ZeroHalfCuts, opts.cuts);
+		cplex.setParam(IloCplex::MCFCuts, opts.cuts);
+		cplex.setParam(IloCplex::LiftProjCuts, opts.cuts);
+	}
+
+	// Branching priorities
+	if (opts.branch_on == BRANCH_LENGTHK) {
+		for (int t = 0; t < NUMBER_OF_TASKS_IN_CHAIN; t++) {
+			if (in.hard.at(t))
+				continue;
+			for (unsigned int l = 0; l < 2 * NUMBER_OF_PATHS; l++)
+				for (unsigned int p = 0; p < 2 * NUMBER_OF_PATHS; p++)
+					cplex.setPriority(v.boolLENGTHK[t][l][p], 1);
+		}
+		cplex.setParam(IloCplex::MIPOrdInd, true);
+	}
+	else if (opts.branch_on == BRANCH_EFFECTIVEJOB) {
+		for (int t = 0; t < NUMBER_OF_TASKS_IN_CHAIN; t++)
+			for (int p = 0; p < NUMBER_OF_PATHS; p++)
+				cplex.setPriority(v.EFFECTIVEJOB[t][p], 1);
+		cplex.setParam(IloCplex::MIPOrdInd, true);
+	}
+}
+
+
+MILPstatus failed_status(IloCplex cplex)
+{
+	switch (cplex.getStatus()) {
+	case IloAlgorithm::Infeasible:
+	case IloAlgorithm::InfeasibleOrUnbounded:
+		return MILP_INFEASIBLE;
+	case IloAlgorithm::Unknown:
+		return MILP_NOSOLUTION;
+	default:
+		return MILP_ERROR;
+	}
+}
+
+
+void refine_conflict(IloCplex cplex, TaskRows &taskrows, MILPresult &MILP_out)
+{
+	IloEnv env = cplex.getEnv();
+	IloConstraintArray groups(env);
+	IloNumArray prefs(env);
+	vector<int> task_of;
+
+	for (int t = 0; t < taskrows.rows.size(); t++) {
+		if (taskrows.rows.at(t).getSize() == 0)
+			continue;
+		IloAnd group(env);
+		group.add(taskrows.rows.at(t));
+		groups.add(group);
+		prefs.add(1.0);
+		task_of.push_back(t);
+	}
+
+	if (cplex.refineConflict(groups, prefs)) {
+		IloCplex::ConflictStatusArray conflict = cplex.getConflict(groups);
+		std::stringstream msg;
+		msg << "Conflicting tasks:";
+		for (int i = 0; i < task_of.size(); i++) {
+			if (conflict[i] == IloCplex::ConflictMember || conflict[i] == IloCplex::ConflictPossibleMember) {
+				MILP_out.conflict_tasks.push_back(task_of.at(i));
+				msg << " " << task_of.at(i);
+			}
+		}
+		MILP_out.message = msg.str();
+		conflict.end();
+	}
+
+	groups.end();
+	prefs.end();
+}
+
+
+void save_solution(IloCplex cplex, const ChainModelInput &in, const ChainVars &v, OptTarget mytarget,
+	IloNumVar OBJ, MILPresult &MILP_out)
+{
+	// Save objective function output
+	if (mytarget == MINIMIZE_UPDATE_INT) {
+		MILP_out.objective = cplex.getValue(-OBJ);
+		MILP_out.bound = -cplex.getBestObjValue();
+	}
+	else {
+		MILP_out.objective = cplex.getValue(OBJ);
+		MILP_out.bound = cplex.getBestObjValue();
+	}
+
+	MILP_out.tasks.clear();
+	for (int t = 0; t < in.taskchain.size(); t++) {
+
+		MILPtaskresult tr;
+		tr.taskid = in.taskchain.at(t).id;
+		tr.offset = cplex.getValue(v.OFFS[t]);
+
+		for (int p = 0; p < NUMBER_OF_PATHS; p++) {
+			tr.missaftereffective.push_back(round(cplex.getValue(v.MISSAFTEREFFECTIVE[t][p])));
+			tr.effective.push_back(round(cplex.getValue(v.EFFECTIVEJOB[t][p])));
+		}
+		for (int p = 0; p < NUMBER_OF_PATHS - 1; p++) {
+			tr.redundhits.push_back(round(cplex.getValue(v.REDUNDHITS[t][p])));
+			tr.missnewinput.push_back(round(cplex.getValue(v.MISSWNEWINPUT[t][p])));
+			tr.voidhits.push_back(round(cplex.getValue(v.VOIDHITS[t][p])));
+		}
+		MILP_out.tasks.push_back(tr);
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// RESULTS FILE
+//-----------------------------------------------------------------------------
+
+void write_results_file(const string &path, const vector<Task> &taskchain, const MILPresult &MILP_out)
+{
+	const int NUMBER_OF_PATHS = MILP_out.tasks.front().effective.size();
+	const int NUMBER_OF_TASKS_IN_CHAIN = MILP_out.tasks.size();
+
+	ofstream results;
+	results.open(path);
+
+	results << "Task" << "\t" << "Period" << "\t" << "Offs";
+
+	for (int p = 1; p < NUMBER_OF_PATHS; p++) {
+		results << "\t" << "VMiss" << p;
+		results << "\t" << "Vhit" << p; 
+		results << "\t" << "RedHs" << p;
+		results << "\t" << "Miss" << p;
+		results << "\t" << "IncHs" << p;
+		
+	}
+	results << "\t" << "VMiss" << NUMBER_OF_PATHS;
+	results << "\t" << "Vhit" << NUMBER_OF_PATHS;
+	results << endl;
+
+	for (int t = 0; t < NUMBER_OF_TASKS_IN_CHAIN; t++) {
+
+		const MILPtaskresult &tr = MILP_out.tasks.at(t);
+
+		results << tr.taskid << "\t" << taskchain.at(t).period << "\t";
+		results << tr.offset;
+		
+		for (int p = 0; p < NUMBER_OF_PATHS - 1; p++) {
+			results << "\t" << tr.missaftereffective.at(p);
+			results << "\t" << tr.effective.at(p);
+			results << "\t" << tr.redundhits.at(p);
+			results << "\t" << tr.missnewinput.at(p);
+			results << "\t" << tr.voidhits.at(p);
+		}
+		results << "\t" << tr.missaftereffective.at(NUMBER_OF_PATHS - 1);
+		results << "\t" << tr.effective.at(NUMBER_OF_PATHS - 1);
+
+		results << endl;
+	}
+	results.close();
+}
@@ -0,0 +1,111 @@
+#ifndef MILP_MODEL_H__
+#define MILP_MODEL_H__
+
+#include <ilcplex/ilocplex.h>
+#include <vector>
+#include <string>
+
+#include "milp_data.h"
+
+//-----------------------------------------------------------------------------
+// Concert model of MILP_WH_K, built task by task
+//
+// Variables are held per task of the chain. Rows are grouped per task: group t holds the rows of
+// task t, those of the link (t-1, t) and the head or tail rows when t is the head or the tail. The
+// rows of group t only depend on tasks t-1 and t and on their position in the chain, so that an edit
+// of task t only touches groups t-1 to t+1 (see milp_edit.h).
+//-----------------------------------------------------------------------------
+
+// Paths of the chain compared by the model (two consecutive effective paths)
+const int NUMBER_OF_PATHS = 2;
+
+typedef IloArray<IloIntVarArray>   IntVarMatrix;
+
+// Chain, normalized constraints and presolve flags the model is built from
+struct ChainModelInput {
+	const std::vector<Task> &taskchain;
+	const std::vector<WHconstr> &setofmk;
+	const std::vector<bool> &hard;
+	const std::vector<bool> &harmonic;
+	const MILPoptions &opts;
+};
+
+// Variables of the model, one entry per task of the chain
+struct ChainVars {
+	std::vector<IloNumVar> OFFS;
+	std::vector<IloIntVarArray> EFFECTIVEJOB;
+	std::vector<IloIntVarArray> REDUNDHITS;
+	std::vector<IloIntVarArray> MISSWNEWINPUT;
+	std::vector<IloIntVarArray> VOIDHITS;
+	std::vector<IloIntVarArray> MISSAFTEREFFECTIVE;
+	std::vector<IloIntVarArray> boolVOIDJOBS;
+	std::vector<IntVarMatrix> boolLENGTHK;		// weakly-hard tasks only
+	std::vector<IloNumVar> PHASE;				// harmonic links only, entry t for link (t-1, t)
+	std::vector<bool> has_phase;
+};
+
+// Rows of the model grouped by task, rows of a link going with its consumer
+struct TaskRows {
+	IloModel model;
+	std::vector<IloConstraintArray> rows;		// in the model
+	std::vector<IloConstraintArray> cuts;		// valid inequalities for the user cut pool
+
+	TaskRows(IloModel model, int num_tasks);
+
+	void add(int t, const IloConstraint &c);
+	void cut(int t, const IloConstraint &c);
+
+	// Empty group at position t
+	void insert(int t);
+
+	// Rows and cuts of group t are ended, and so leave the model
+	void clear(int t);
+	void erase(int t);
+
+	// Cuts of every group
+	IloConstraintArray all_cuts() const;
+
+	// The arrays only: rows belong to the model (cuts are ended)
+	void end();
+};
+
+// Variables of task t, inserted at position t and added to the model (not the phase of its link)
+void add_task_vars(IloModel model, const ChainModelInput &in, ChainVars &v, int t);
+void end_task_vars(ChainVars &v, int t);
+
+// Bounds of the variables of task t after a change of its period
+void retime_task_vars(const ChainModelInput &in, ChainVars &v, int t);
+
+// Phase of link (t-1, t), if harmonic
+void add_link_vars(IloModel model, const ChainModelInput &in, ChainVars &v, int t);
+void end_link_vars(ChainVars &v, int t);
+
+// Names by position in the chain, for exported models
+void name_vars(const ChainModelInput &in, ChainVars &v);
+
+// Rows of group t (constraints 1-13 and valid inequalities)
+void add_task_rows(const ChainModelInput &in, const ChainVars &v, int t, TaskRows &rows);
+
+// Bounds on the effective jobs: from first_effective_job_bounds with VALID_EJ_BOUNDS, the job indices otherwise
+void set_effective_job_bounds(const ChainModelInput &in, ChainVars &v);
+
+// Row bounding OBJ by the target on the tail (false for an unknown target)
+bool objective_row(const ChainModelInput &in, const ChainVars &v, OptTarget mytarget, IloNumVar OBJ, IloConstraint &row);
+
+// Cut aggressiveness and branching priorities of the options
+void set_search_params(IloCplex cplex, const ChainModelInput &in, const ChainVars &v);
+
+// Status of a solve that returned no solution
+MILPstatus failed_status(IloCplex cplex);
+
+// Minimal set of tasks whose rows are infeasible together (conflict refiner over one group per task)
+void refine_conflict(IloCplex cplex, TaskRows &taskrows, MILPresult &MILP_out);
+
+// Objective, bound and per-task values of the incumbent
+void save_solution(IloCplex cplex, const ChainModelInput &in, const ChainVars &v, OptTarget mytarget,
+	IloNumVar OBJ, MILPresult &MILP_out);
+
+// Solution table, one line per task
+void write_results_file(const std::string &path, const std::vector<Task> &taskchain, const MILPresult &MILP_out);
+
+#endif
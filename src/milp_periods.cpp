@@ -0,0 +1,356 @@
+#include <ilcplex/ilocplex.h>
+
+#include "milp_periods.h"
+#include "milp_WHchain.h"
+#include "milp_edit.h"
+
+#include <thread>
+#include <condition_variable>
+#include <queue>
+#include <map>
+#include <memory>
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+using namespace std;
+
+ILOSTLBEGIN
+
+#define TOL 0.001
+
+
+//-----------------------------------------------------------------------------
+// CACHE
+//-----------------------------------------------------------------------------
+
+bool PeriodCache::lookup(uint64_t key, MILPresult &res)
+{
+	lock_guard<mutex> lock(mtx);
+
+	auto it = results.find(key);
+	if (it == results.end())
+		return false;
+
+	res = it->second;
+	return true;
+}
+
+
+void PeriodCache::store(uint64_t key, const MILPresult &res)
+{
+	lock_guard<mutex> lock(mtx);
+	results[key] = res;
+}
+
+
+// Key of an analysis in the cache: chain and target
+static uint64_t analysis_key(const vector<Task> &taskchain, const vector<WHconstr> &setofmk, OptTarget mytarget)
+{
+	uint64_t h = chain_hash(taskchain, setofmk);
+	h ^= static_cast<uint64_t>(mytarget) + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+	return h;
+}
+
+
+//-----------------------------------------------------------------------------
+// SEARCH TREE
+//-----------------------------------------------------------------------------
+
+// Periods of the first tasks of the chain
+struct PeriodNode {
+	double bound;
+	vector<int> periods;
+};
+
+// Smallest bound first; deeper nodes first among equal bounds, to reach complete assignments early
+struct WorseNode {
+	bool operator()(const PeriodNode &a, const PeriodNode &b) const {
+		if (a.bound != b.bound)
+			return a.bound > b.bound;
+		return a.periods.size() < b.periods.size();
+	}
+};
+
+// Allowed periods and their share of the bound, per task
+struct PeriodSpace {
+	vector<vector<int> > choices;		// ascending
+	vector<double> rest;				// smallest share of the bound of tasks t..N-1
+	map<int, vector<double> > core_rest;	// smallest utilization of tasks t..N-1, per core
+};
+
+
+static bool has_solution(const MILPresult &res)
+{
+	return res.status == MILP_OPTIMAL || res.status == MILP_FEASIBLE;
+}
+
+
+// Share of task t with period p in the bound on the target
+static double bound_share(const vector<Task> &taskchain, OptTarget mytarget, bool implicit, int t, int p)
+{
+	if (mytarget == MAXIMIZE_DATAAGE && t == taskchain.size() - 1)
+		return p;
+	return implicit ? p : taskchain.at(t).deadline;
+}
+
+
+// Utilization of every core stays under the cap whatever the periods of the tasks not yet assigned
+static bool fits(const vector<Task> &taskchain, const PeriodSpace &space, const vector<int> &periods, double cap)
+{
+	for (auto it = space.core_rest.begin(); it != space.core_rest.end(); ++it) {
+		double util = it->second.at(periods.size());
+		for (int t = 0; t < periods.size(); t++)
+			if (taskchain.at(t).core_id == it->first)
+				util += (double)taskchain.at(t).wcet / periods.at(t);
+		if (util > cap + 1e-9)
+			return false;
+	}
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------
+// OPTIMIZER
+//-----------------------------------------------------------------------------
+
+PeriodSearchResult optimize_periods(const vector<Task> &taskchain, const vector<WHconstr> &setofmk,
+	OptTarget mytarget, const PeriodSearchOptions &popts)
+{
+	auto start_time = chrono::steady_clock::now();
+
+	PeriodSearchResult out;
+	const int N = taskchain.size();
+
+	if (mytarget != MAXIMIZE_LATENCY && mytarget != MAXIMIZE_DATAAGE) {
+		out.status = MILP_INVALID;
+		out.message = "Period assignment minimizes the worst-case latency or data age only";
+		return out;
+	}
+	if (N == 0 || setofmk.size() != N) {
+		out.status = MILP_INVALID;
+		out.message = "Empty chain or one (m,k) constraint per task missing";
+		return out;
+	}
+
+	//-----------------------------------------------------------------------------
+	// Allowed periods, bounds of the tasks not yet assigned
+	//-----------------------------------------------------------------------------
+
+	PeriodSpace space;
+	space.choices.resize(N);
+	space.rest.assign(N + 1, 0);
+
+	for (int t = 0; t < N; t++) {
+		vector<int> allowed;
+		if (t < popts.allowed.size())
+			allowed = popts.allowed.at(t);
+		if (allowed.empty())
+			allowed.push_back(taskchain.at(t).period);
+
+		for (int i = 0; i < allowed.size(); i++) {
+			int p = allowed.at(i);
+			if (p > 0 && (popts.implicit_deadlines || p >= taskchain.at(t).deadline))
+				space.choices.at(t).push_back(p);
+		}
+		sort(space.choices.at(t).begin(), space.choices.at(t).end());
+		space.choices.at(t).erase(unique(space.choices.at(t).begin(), space.choices.at(t).end()), space.choices.at(t).end());
+
+		if (space.choices.at(t).empty()) {
+			out.status = MILP_INFEASIBLE;
+			out.message = "No allowed period for task at position " + to_string(t);
+			return out;
+		}
+	}
+
+	for (int t = N - 1; t >= 0; t--)
+		space.rest.at(t) = space.rest.at(t + 1) + bound_share(taskchain, mytarget, popts.implicit_deadlines, t, space.choices.at(t).front());
+
+	// Largest periods for the smallest utilization
+	for (int t = 0; t < N; t++)
+		space.core_rest[taskchain.at(t).core_id].assign(N + 1, 0);
+	for (auto it = space.core_rest.begin(); it != space.core_rest.end(); ++it) {
+		for (int t = N - 1; t >= 0; t--) {
+			it->second.at(t) = it->second.at(t + 1);
+			if (taskchain.at(t).core_id == it->first)
+				it->second.at(t) += (double)taskchain.at(t).wcet / space.choices.at(t).back();
+		}
+	}
+
+	//-----------------------------------------------------------------------------
+	// Best-first branch-and-bound, shared by the workers
+	//-----------------------------------------------------------------------------
+
+	priority_queue<PeriodNode, vector<PeriodNode>, WorseNode> frontier;
+	mutex mtx;
+	condition_variable changed;
+	int busy = 0;					// workers analyzing a candidate
+	bool stopped = false;			// max_evals reached
+	long long launched = 0;			// complete assignments taken by the workers
+	bool has_best = false;
+	double best_value = 0;
+
+	PeriodNode root;
+	root.bound = space.rest.at(0);
+	if (fits(taskchain, space, root.periods, popts.util_cap))
+		frontier.push(root);
+	else
+		out.pruned_util++;
+
+	int num_workers = (popts.workers > 0) ? popts.workers : max(1u, thread::hardware_concurrency());
+	vector<thread> workers;
+
+	for (int w = 0; w < num_workers; w++) {
+		workers.push_back(thread([&]() {
+			unique_ptr<WHchainModel> model;
+			MILPworkspace *ws = popts.warm_start ? NULL : MILP_create_workspace();
+
+			unique_lock<mutex> lock(mtx);
+			while (!stopped) {
+				if (frontier.empty()) {
+					if (busy == 0)
+						break;
+					changed.wait(lock);
+					continue;
+				}
+
+				PeriodNode node = frontier.top();
+				frontier.pop();
+
+				// Best-first: nothing left can improve on the best assignment
+				if (has_best && node.bound >= best_value - TOL) {
+					out.pruned_bound += frontier.size() + 1;
+					frontier = priority_queue<PeriodNode, vector<PeriodNode>, WorseNode>();
+					changed.notify_all();
+					continue;
+				}
+
+				// Partial assignment: branch on the periods of the next task
+				if (node.periods.size() < N) {
+					const int t = node.periods.size();
+					out.nodes++;
+					for (int i = 0; i < space.choices.at(t).size(); i++) {
+						const int p = space.choices.at(t).at(i);
+						PeriodNode child;
+						child.periods = node.periods;
+						child.periods.push_back(p);
+						child.bound = node.bound - bound_share(taskchain, mytarget, popts.implicit_deadlines, t, space.choices.at(t).front())
+							+ bound_share(taskchain, mytarget, popts.implicit_deadlines, t, p);
+						if (!fits(taskchain, space, child.periods, popts.util_cap)) {
+							out.pruned_util++;
+							continue;
+						}
+						frontier.push(child);
+					}
+					changed.notify_all();
+					continue;
+				}
+
+				// Complete assignment
+				if (popts.max_evals > 0 && launched >= popts.max_evals) {
+					frontier.push(node);
+					stopped = true;
+					changed.notify_all();
+					break;
+				}
+				launched++;
+				busy++;
+				lock.unlock();
+
+				vector<Task> chain = taskchain;
+				for (int t = 0; t < N; t++) {
+					chain.at(t).period = node.periods.at(t);
+					if (popts.implicit_deadlines)
+						chain.at(t).deadline = node.periods.at(t);
+				}
+
+				const uint64_t key = analysis_key(chain, setofmk, mytarget);
+				MILPresult res;
+				bool from_cache = (popts.cache != nullptr) && popts.cache->lookup(key, res);
+
+				if (!from_cache) {
+					if (!popts.warm_start)
+						res = MILP_WH_K(chain, setofmk, mytarget, popts.milp, ws);
+					else {
+						// Building the solver or the rows of an edit may throw (no license, out of memory):
+						// the candidate fails, the next one starts from a fresh model
+						try {
+							bool edited = true;
+							if (!model)
+								model.reset(new WHchainModel(chain, setofmk, mytarget, popts.milp));
+							else {
+								for (int t = 0; t < N && edited; t++)
+									if (model->chain().at(t).period != chain.at(t).period || model->chain().at(t).deadline != chain.at(t).deadline)
+										edited = model->set_timing(t, chain.at(t).period, chain.at(t).deadline);
+							}
+							if (edited)
+								res = model->solve();
+							else {
+								res.status = MILP_INVALID;
+								res.message = "Assignment rejected by validate_chain";
+							}
+						}
+						catch (IloException &e) {
+							std::stringstream msg;
+							msg << "Concert exception caught: " << e;
+							res = MILPresult();
+							res.status = MILP_ERROR;
+							res.message = msg.str();
+							model.reset();
+						}
+					}
+					if (popts.cache != nullptr && res.status != MILP_ERROR)
+						popts.cache->store(key, res);
+				}
+
+				if (popts.verbose) {
+					string periods;
+					for (int t = 0; t < N; t++)
+						periods += (t > 0 ? "," : "") + to_string(chain.at(t).period);
+					cerr << "[PERIODS] " << periods << " status " << res.status << " bound " << res.bound
+						<< (from_cache ? " (cached)" : "") << endl;
+				}
+
+				lock.lock();
+				busy--;
+				if (from_cache)
+					out.cached++;
+				else
+					out.evaluated++;
+
+				if (!has_solution(res))
+					out.rejected++;
+				else if (!has_best || res.bound < best_value - TOL) {
+					has_best = true;
+					best_value = res.bound;
+					out.periods = node.periods;
+					out.best = res;
+				}
+				changed.notify_all();
+			}
+			lock.unlock();
+
+			if (ws != NULL)
+				MILP_free_workspace(ws);
+		}));
+	}
+	for (int w = 0; w < workers.size(); w++)
+		workers.at(w).join();
+
+	if (has_best) {
+		out.status = stopped ? MILP_FEASIBLE : MILP_OPTIMAL;
+	}
+	else if (stopped) {
+		out.status = MILP_NOSOLUTION;
+		out.message = "No assignment solved within max_evals";
+	}
+	else {
+		out.status = MILP_INFEASIBLE;
+		out.message = "No assignment within the utilization cap has a solution";
+	}
+
+	auto end_time = chrono::steady_clock::now();
+	out.runtime = chrono::duration<double>(end_time - start_time).count();
+
+	return out;
+}
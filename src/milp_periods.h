@@ -0,0 +1,77 @@
+#ifndef MILP_PERIODS_H__
+#define MILP_PERIODS_H__
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+
+#include "milp_data.h"
+
+//-----------------------------------------------------------------------------
+// Period assignment
+//
+// Periods are chosen for every task of the chain from a set of allowed values, so as to minimize the
+// worst-case latency or data age under the weakly-hard constraints of the chain and a utilization cap
+// per core (sum of wcet / period of the tasks with the same core_id). The search is a best-first
+// branch-and-bound that assigns the tasks in chain order:
+//   - a partial assignment is dropped when its tasks, plus the smallest utilization of the others,
+//     exceed the cap of a core
+//   - its bound is the sum of the deadlines (latency), or of the deadlines but the tail plus the
+//     period of the tail (data age), with the smallest allowed values for the tasks not yet assigned.
+//     Under LET a task reads the output of its producer at the producer's deadline at the earliest,
+//     so no path is shorter.
+//   - complete assignments are analyzed by `workers` threads in parallel, and ranked by the bound
+//     the solver proves on their worst case (safe even when the analysis stops at the gap or at the
+//     time limit). The search ends when the smallest bound left cannot improve on the best one.
+// Each worker analyzes its candidates through a WHchainModel (see milp_edit.h), retiming the tasks
+// that differ from its previous candidate, so the analyses are warm-started from the tasks upstream of
+// the first retimed one (the search assigns the tasks in chain order, so candidates popped one after
+// the other tend to share a prefix). Analyses can be cached across searches.
+//-----------------------------------------------------------------------------
+
+// Analyses of complete assignments, by chain_hash and target
+class PeriodCache {
+public:
+	bool lookup(uint64_t key, MILPresult &res);
+	void store(uint64_t key, const MILPresult &res);
+
+private:
+	std::mutex mtx;
+	std::unordered_map<uint64_t, MILPresult> results;
+};
+
+struct PeriodSearchOptions {
+	std::vector<std::vector<int> > allowed;	// allowed periods of each task (missing or empty: its current period)
+	double util_cap = 1.0;			// per core
+	bool implicit_deadlines = true;	// deadline = period; otherwise deadlines are kept and shorter periods skipped
+	int workers = 0;				// analyses in parallel (0: one per core)
+	bool warm_start = true;			// one WHchainModel per worker rather than a new model per analysis
+	long long max_evals = 0;		// complete assignments analyzed at most (0: unbounded)
+	PeriodCache *cache = nullptr;	// shared by searches with the same MILP settings (nullptr: none)
+	MILPoptions milp;				// settings of every analysis (threads: per analysis)
+	bool verbose = false;			// one line per analysis on stderr
+};
+
+struct PeriodSearchResult {
+	MILPstatus status = MILP_ERROR;	// MILP_OPTIMAL: search complete, MILP_FEASIBLE: stopped at max_evals,
+									// MILP_NOSOLUTION: stopped before any solution, MILP_INFEASIBLE: no
+									// admissible assignment, MILP_INVALID: unsupported target or bad input
+	std::string message;
+	std::vector<int> periods;		// best assignment, by position in the chain
+	MILPresult best;				// its analysis
+	long long nodes = 0;			// partial assignments expanded
+	long long pruned_util = 0;		// assignments over the utilization cap
+	long long pruned_bound = 0;		// assignments whose bound cannot improve on the best one
+	long long evaluated = 0;		// analyses run
+	long long cached = 0;			// analyses answered by the cache
+	long long rejected = 0;			// complete assignments without a solution (infeasible, invalid, time limit)
+	double runtime = 0;				// wall-clock seconds
+};
+
+// Targets MAXIMIZE_LATENCY and MAXIMIZE_DATAAGE only (the worst case is minimized)
+PeriodSearchResult optimize_periods(const std::vector<Task> &taskchain, const std::vector<WHconstr> &setofmk,
+	OptTarget mytarget, const PeriodSearchOptions &popts);
+
+#endif
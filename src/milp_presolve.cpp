@@ -0,0 +1,245 @@
+#include "milp_presolve.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <sstream>
+
+using namespace std;
+
+
+bool validate_chain(const vector<Task> &taskchain, const vector<WHconstr> &setofmk, string &message, vector<int> &tasks)
+{
+	stringstream msg;
+	tasks.clear();
+
+	if (taskchain.empty())
+		msg << "chain: no task\n";
+	if (setofmk.size() != taskchain.size())
+		msg << "chain: " << taskchain.size() << " tasks but " << setofmk.size() << " weakly-hard constraints\n";
+
+	for (int t = 0; t < taskchain.size(); t++) {
+		const Task &task = taskchain.at(t);
+		stringstream issues;
+
+		if (task.period <= 0)
+			issues << " period " << task.period << " not positive;";
+		if (task.deadline <= 0)
+			issues << " deadline " << task.deadline << " not positive;";
+		if (task.deadline > task.period)
+			issues << " deadline " << task.deadline << " larger than period " << task.period << ";";
+
+		// Release and completion of the last job index must stay below the big-M of the model
+		if ((long long)task.period * (UINT16_MAX + 1) + task.deadline > INT_MAX)
+			issues << " period " << task.period << " overflows the horizon of the model;";
+
+		if (t < setofmk.size()) {
+			const WHconstr &whc = setofmk.at(t);
+			if (whc.mconsec < 0)
+				issues << " mconsec " << whc.mconsec << " negative;";
+			for (int i = 0; i < whc.mk.size(); i++) {
+				const MKconstr &mkc = whc.mk.at(i);
+				if (mkc.k < 1)
+					issues << " k " << mkc.k << " below 1;";
+				if (mkc.m < 0)
+					issues << " m " << mkc.m << " negative;";
+				if (mkc.m > mkc.k)
+					issues << " (" << mkc.m << "," << mkc.k << ") has m larger than k;";
+				if (mkc.m >= 0 && whc.mconsec > mkc.m)
+					issues << " mconsec " << whc.mconsec << " larger than m of (" << mkc.m << "," << mkc.k << ");";
+			}
+		}
+
+		if (!issues.str().empty()) {
+			msg << "task " << t << " (id " << task.id << "):" << issues.str() << "\n";
+			tasks.push_back(t);
+		}
+	}
+
+	message = msg.str();
+	return message.empty();
+}
+
+
+int max_misses_mk(const MKconstr &mkc, int n)
+{
+	if (mkc.m >= mkc.k)
+		return n;
+
+	// Worst pattern: m misses followed by k-m hits, repeated
+	int q = n / mkc.k;
+	int r = n % mkc.k;
+	return q * mkc.m + min(r, mkc.m);
+}
+
+
+int max_misses_consec(int mconsec, int n)
+{
+	if (mconsec < 0)
+		return 0;
+
+	// Worst pattern: mconsec misses followed by one hit, repeated
+	int q = n / (mconsec + 1);
+	int r = n % (mconsec + 1);
+	return q * mconsec + min(r, mconsec);
+}
+
+
+bool mk_implies(const MKconstr &a, const MKconstr &b)
+{
+	if (b.m >= b.k)
+		return true;
+
+	return max_misses_mk(a, b.k) <= b.m;
+}
+
+
+WHconstr normalize_whconstr(const WHconstr &whc)
+{
+	WHconstr norm;
+	norm.taskid = whc.taskid;
+	norm.mconsec = whc.mconsec;
+
+	// Drop trivial pairs
+	vector<MKconstr> mk;
+	for (int i = 0; i < whc.mk.size(); i++) {
+		if (whc.mk.at(i).m < whc.mk.at(i).k)
+			mk.push_back(whc.mk.at(i));
+	}
+
+	// Hard task
+	for (int i = 0; i < mk.size(); i++) {
+		if (mk.at(i).m <= 0)
+			norm.mconsec = 0;
+	}
+	if (norm.mconsec <= 0) {
+		MKconstr hard;
+		hard.m = 0;
+		hard.k = 1;
+		norm.mconsec = 0;
+		norm.mk.push_back(hard);
+		return norm;
+	}
+
+	// A run of consecutive misses fits in any window of k jobs
+	for (int i = 0; i < mk.size(); i++)
+		norm.mconsec = min(norm.mconsec, mk.at(i).m);
+
+	// Keep the pairs that neither mconsec nor another kept pair implies.
+	// Of two equivalent pairs, the first one is kept.
+	vector<bool> dropped(mk.size(), false);
+	for (int i = 0; i < mk.size(); i++) {
+
+		if (max_misses_consec(norm.mconsec, mk.at(i).k) <= mk.at(i).m) {
+			dropped.at(i) = true;
+			continue;
+		}
+
+		for (int j = 0; j < mk.size(); j++) {
+			if (j == i || dropped.at(j) || !mk_implies(mk.at(j), mk.at(i)))
+				continue;
+			if (mk_implies(mk.at(i), mk.at(j)) && i < j)
+				continue;
+			dropped.at(i) = true;
+			break;
+		}
+	}
+
+	for (int i = 0; i < mk.size(); i++) {
+		if (!dropped.at(i))
+			norm.mk.push_back(mk.at(i));
+	}
+
+	return norm;
+}
+
+
+vector<WHconstr> normalize_constraints(const vector<WHconstr> &setofmk)
+{
+	vector<WHconstr> norm;
+
+	for (int t = 0; t < setofmk.size(); t++)
+		norm.push_back(normalize_whconstr(setofmk.at(t)));
+
+	return norm;
+}
+
+
+bool is_hard(const WHconstr &whc)
+{
+	if (whc.mconsec <= 0)
+		return true;
+
+	for (int i = 0; i < whc.mk.size(); i++) {
+		if (whc.mk.at(i).m <= 0)
+			return true;
+	}
+
+	return false;
+}
+
+
+vector<bool> hard_tasks(const vector<WHconstr> &setofmk)
+{
+	vector<bool> hard;
+
+	for (int t = 0; t < setofmk.size(); t++)
+		hard.push_back(is_hard(setofmk.at(t)));
+
+	return hard;
+}
+
+
+bool is_harmonic_link(const Task &producer, const Task &consumer)
+{
+	if (producer.period <= 0 || consumer.period <= 0)
+		return false;
+
+	return producer.period % consumer.period == 0;
+}
+
+
+vector<bool> harmonic_links(const vector<Task> &taskchain)
+{
+	vector<bool> harmonic(taskchain.size(), false);
+
+	for (int t = 1; t < taskchain.size(); t++)
+		harmonic.at(t) = is_harmonic_link(taskchain.at(t - 1), taskchain.at(t));
+
+	return harmonic;
+}
+
+
+int period_gcd(int a, int b)
+{
+	while (b != 0) {
+		int r = a % b;
+		a = b;
+		b = r;
+	}
+	return a;
+}
+
+
+void first_effective_job_bounds(const vector<Task> &taskchain, const vector<WHconstr> &setofmk,
+	const vector<bool> &hard, vector<int> &lo, vector<int> &hi)
+{
+	const int N = taskchain.size();
+	lo.assign(N, 0);
+	hi.assign(N, UINT16_MAX);
+
+	// Earliest and latest activation of the first effective job (head: time 0)
+	long long earliest = 0, latest = 0;
+	hi.at(0) = 0;
+	for (int t = 1; t < N; t++) {
+		const long long T = taskchain.at(t).period;
+		const long long mconsec = hard.at(t) ? 0 : setofmk.at(t).mconsec;
+
+		earliest += taskchain.at(t - 1).deadline;
+		latest += taskchain.at(t - 1).deadline + T * (mconsec + 1);
+
+		// earliest - T < T * index < latest (offsets in [0, T))
+		lo.at(t) = (int)min((long long)UINT16_MAX, earliest / T);
+		hi.at(t) = (int)min((long long)UINT16_MAX, (latest + T - 1) / T - 1);
+	}
+}
@@ -0,0 +1,53 @@
+#ifndef MILP_PRESOLVE_H__
+#define MILP_PRESOLVE_H__
+
+#include <vector>
+#include <string>
+
+#include "milp_data.h"
+
+// Checks a chain before the model is built, in time linear in its size. Rejects malformed inputs
+// (empty chain, sizes that differ, k < 1, m < 0, mconsec < 0, period or deadline not positive,
+// deadline larger than period, periods too large for the job indices of the model) and inconsistent
+// constraints (m > k, mconsec > m). Returns false with one line per problem in message and the
+// positions of the offending tasks in tasks.
+bool validate_chain(const std::vector<Task> &taskchain, const std::vector<WHconstr> &setofmk,
+	std::string &message, std::vector<int> &tasks);
+
+// Largest number of misses in a window of n consecutive jobs allowed by (m,k) alone
+int max_misses_mk(const MKconstr &mkc, int n);
+
+// Largest number of misses in a window of n consecutive jobs with at most mconsec consecutive misses
+int max_misses_consec(int mconsec, int n);
+
+// True if every sequence satisfying a also satisfies b
+bool mk_implies(const MKconstr &a, const MKconstr &b);
+
+// Equivalent weakly-hard constraint without redundant (m,k) pairs and with the tightest mconsec:
+// trivial pairs (m >= k) are dropped, hard tasks become (0,1) with mconsec = 0, mconsec is bounded
+// by every m, and pairs implied by another pair or by mconsec are removed
+WHconstr normalize_whconstr(const WHconstr &whc);
+std::vector<WHconstr> normalize_constraints(const std::vector<WHconstr> &setofmk);
+
+// A task is hard if it can never miss a deadline: mconsec = 0 or some (m,k) with m = 0
+bool is_hard(const WHconstr &whc);
+
+// Flag hard tasks, position by position
+std::vector<bool> hard_tasks(const std::vector<WHconstr> &setofmk);
+
+// A link producer -> consumer is harmonic if the consumer period divides the producer period
+bool is_harmonic_link(const Task &producer, const Task &consumer);
+
+// Flag harmonic links, entry t for link (t-1, t); entry 0 is always false
+std::vector<bool> harmonic_links(const std::vector<Task> &taskchain);
+
+// Greatest common divisor of two periods
+int period_gcd(int a, int b);
+
+// Range [lo, hi] of the index of the first effective job of each task. Its activation comes after the
+// deadlines of all the producers, and at most mconsec + 1 periods after the completion of the effective
+// job of its producer (hard tasks: one period). Bounds are clamped to the job indices of the model.
+void first_effective_job_bounds(const std::vector<Task> &taskchain, const std::vector<WHconstr> &setofmk,
+	const std::vector<bool> &hard, std::vector<int> &lo, std::vector<int> &hi);
+
+#endif
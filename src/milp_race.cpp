@@ -0,0 +1,211 @@
+#include "milp_race.h"
+#include "milp_WHchain.h"
+
+#include <thread>
+#include <chrono>
+#include <cmath>
+
+using namespace std;
+
+
+//-----------------------------------------------------------------------------
+// SHARED STATE
+//-----------------------------------------------------------------------------
+
+void MILPrace::publish(double incumbent)
+{
+	lock_guard<mutex> lock(mtx);
+	if (!has_best || incumbent > best) {
+		best = incumbent;
+		has_best = true;
+	}
+}
+
+
+bool MILPrace::best_incumbent(double &value) const
+{
+	lock_guard<mutex> lock(mtx);
+	value = best;
+	return has_best;
+}
+
+
+void MILPrace::finish()
+{
+	lock_guard<mutex> lock(mtx);
+	if (done)
+		return;
+	done = true;
+	for (auto it = aborters.begin(); it != aborters.end(); ++it)
+		it->second();
+}
+
+
+bool MILPrace::finished() const
+{
+	lock_guard<mutex> lock(mtx);
+	return done;
+}
+
+
+int MILPrace::register_abort(const function<void()> &abort_fn)
+{
+	lock_guard<mutex> lock(mtx);
+	int id = next_id++;
+	aborters[id] = abort_fn;
+
+	// Joining a race that is already over
+	if (done)
+		abort_fn();
+	return id;
+}
+
+
+void MILPrace::unregister_abort(int id)
+{
+	lock_guard<mutex> lock(mtx);
+	aborters.erase(id);
+}
+
+
+//-----------------------------------------------------------------------------
+// PORTFOLIO
+//-----------------------------------------------------------------------------
+
+vector<MILPoptions> default_portfolio(const MILPoptions &base, int num_configs)
+{
+	vector<MILPoptions> configs;
+	if (num_configs < 1)
+		num_configs = 1;
+
+	// Candidate settings, in order of usefulness on the perceptin chains
+	const int num_settings = 6;
+	for (int i = 0; i < num_configs; i++) {
+		MILPoptions opts = base;
+		opts.race = nullptr;
+		opts.export_model.clear();
+		opts.results_file.clear();
+		opts.threads = max(1, base.threads / num_configs);
+
+		switch (i % num_settings) {
+		case 0:					// as given, tuned profile included
+			break;
+		case 1:					// feasibility first, aggressive heuristics
+			opts.mipemphasis = 1;
+			opts.heurfreq = 10;
+			break;
+		case 2:					// bound first, aggressive cuts, structural valid inequalities
+			opts.mipemphasis = 3;
+			opts.cuts = 2;
+			opts.valid_ineq = VALID_ALL;
+			break;
+		case 3:					// decide the sequences of misses first
+			opts.branch_on = BRANCH_LENGTHK;
+			break;
+		case 4:					// decide the effective jobs first
+			opts.branch_on = BRANCH_EFFECTIVEJOB;
+			opts.heurfreq = 20;
+			break;
+		case 5:					// optimality, no cuts
+			opts.mipemphasis = 2;
+			opts.cuts = -1;
+			break;
+		}
+
+		// A profile would override the settings of the portfolio
+		if (i > 0)
+			opts.profiles = nullptr;
+
+		// Further copies of the same settings only differ in the seed
+		if (i >= num_settings)
+			opts.random_seed = i;
+
+		configs.push_back(opts);
+	}
+
+	return configs;
+}
+
+
+//-----------------------------------------------------------------------------
+// RACE
+//-----------------------------------------------------------------------------
+
+static bool has_solution(const MILPresult &res)
+{
+	return res.status == MILP_OPTIMAL || res.status == MILP_FEASIBLE;
+}
+
+
+MILPresult MILP_WH_K_race(const vector<Task> &taskchain, const vector<WHconstr> &setofmk,
+	OptTarget mytarget, const vector<MILPoptions> &configs)
+{
+	auto start_time = chrono::steady_clock::now();
+
+	MILPresult out;
+	if (configs.empty())
+		return out;
+
+	MILPrace race;
+	vector<MILPresult> results(configs.size());
+	vector<thread> racers;
+
+	for (int i = 0; i < configs.size(); i++) {
+		racers.push_back(thread([&, i]() {
+			MILPoptions opts = configs.at(i);
+			opts.race = &race;
+			results.at(i) = MILP_WH_K(taskchain, setofmk, mytarget, opts);
+		}));
+	}
+	for (int i = 0; i < racers.size(); i++)
+		racers.at(i).join();
+
+	// Best solution and tightest bound of all racers.
+	// Results are in the user sense: the bound is a lower bound when minimizing.
+	const bool minimize = (mytarget == MINIMIZE_UPDATE_INT);
+	int winner = -1;
+	bool has_bound = false;
+	double bound = 0;
+
+	for (int i = 0; i < results.size(); i++) {
+		const MILPresult &res = results.at(i);
+
+		// An infeasible model is infeasible for every setting
+		if (res.status == MILP_INFEASIBLE) {
+			out = res;
+			winner = -1;
+			has_bound = false;
+			break;
+		}
+		if (!has_solution(res))
+			continue;
+
+		if (winner < 0 || (minimize ? res.objective < results.at(winner).objective : res.objective > results.at(winner).objective))
+			winner = i;
+		if (!has_bound || (minimize ? res.bound > bound : res.bound < bound)) {
+			bound = res.bound;
+			has_bound = true;
+		}
+	}
+
+	if (winner >= 0) {
+		out = results.at(winner);
+		out.bound = bound;
+
+		double gap = fabs(out.bound - out.objective);
+		out.status = (gap <= configs.at(winner).epgap * fabs(out.objective) + 0.001) ? MILP_OPTIMAL : MILP_FEASIBLE;
+		out.message.clear();
+	}
+	else if (out.status != MILP_INFEASIBLE) {
+		// No racer found a solution: report the most informative failure
+		out = results.at(0);
+		for (int i = 1; i < results.size(); i++)
+			if (results.at(i).status < out.status)
+				out = results.at(i);
+	}
+
+	auto end_time = chrono::steady_clock::now();
+	out.runtime = chrono::duration<double>(end_time - start_time).count();
+
+	return out;
+}
@@ -0,0 +1,54 @@
+#ifndef MILP_RACE_H__
+#define MILP_RACE_H__
+
+#include <vector>
+#include <map>
+#include <mutex>
+#include <functional>
+
+#include "milp_data.h"
+
+//-----------------------------------------------------------------------------
+// Portfolio racing: the same chain is solved concurrently with different solver settings.
+// Racers share the best incumbent value; a racer whose bound cannot beat it, or that proves
+// optimality, stops the whole race.
+// Values are in the sense of the internal model (maximization of OBJ).
+//-----------------------------------------------------------------------------
+
+class MILPrace {
+public:
+	MILPrace() : has_best(false), best(0), done(false), next_id(0) {}
+
+	// Offer an incumbent value found by a racer
+	void publish(double incumbent);
+
+	// Best incumbent value found by any racer so far
+	bool best_incumbent(double &value) const;
+
+	// Stop every racer (the caller included)
+	void finish();
+	bool finished() const;
+
+	// Racers register how to interrupt them while they run
+	int register_abort(const std::function<void()> &abort_fn);
+	void unregister_abort(int id);
+
+private:
+	mutable std::mutex mtx;
+	bool has_best;
+	double best;
+	bool done;
+	int next_id;
+	std::map<int, std::function<void()> > aborters;
+};
+
+// Default portfolio of num_configs settings derived from base: emphasis, cut and heuristic
+// aggressiveness, branching priorities and seeds. The threads of base are split among them.
+std::vector<MILPoptions> default_portfolio(const MILPoptions &base, int num_configs);
+
+// Race the configurations, one thread each. The result carries the best objective and the
+// tightest bound found by any racer.
+MILPresult MILP_WH_K_race(const std::vector<Task> &taskchain, const std::vector<WHconstr> &setofmk,
+	OptTarget mytarget, const std::vector<MILPoptions> &configs);
+
+#endif
@@ -0,0 +1,333 @@
+#include "milp_store.h"
+#include "milp_WHchain.h"
+#include "milp_presolve.h"
+
+#include <fstream>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+
+using namespace std;
+
+
+//-----------------------------------------------------------------------------
+// ENCODING HELPERS
+//-----------------------------------------------------------------------------
+
+template <typename T>
+static void put(vector<char> &buf, T v)
+{
+	const char *p = reinterpret_cast<const char*>(&v);
+	buf.insert(buf.end(), p, p + sizeof(T));
+}
+
+// False, leaving pos unchanged, when the value would run past the end of buf
+template <typename T>
+static bool get(const vector<char> &buf, size_t &pos, T &v)
+{
+	if (pos > buf.size() || buf.size() - pos < sizeof(T))
+		return false;
+	memcpy(&v, buf.data() + pos, sizeof(T));
+	pos += sizeof(T);
+	return true;
+}
+
+// Column sizes of a records block
+static const size_t RECORD_BYTES = sizeof(uint64_t) + 4 * sizeof(int32_t) + 3 * sizeof(double);
+
+
+//-----------------------------------------------------------------------------
+// WRITER
+//-----------------------------------------------------------------------------
+
+ResultsWriter::ResultsWriter(const string &path, size_t batch_size)
+	: path(path), batch_size(max<size_t>(1, batch_size))
+{
+}
+
+
+ResultsWriter::~ResultsWriter()
+{
+	flush();
+}
+
+
+uint64_t ResultsWriter::add_chain(const vector<Task> &taskchain, const vector<WHconstr> &setofmk)
+{
+	uint64_t h = chain_hash(taskchain, setofmk);
+
+	lock_guard<mutex> lock(write_mutex);
+	if (chains_written.count(h) > 0)
+		return h;
+
+	vector<char> payload;
+	put<uint64_t>(payload, h);
+	put<int32_t>(payload, taskchain.size());
+	for (int t = 0; t < taskchain.size(); t++) {
+		put<int32_t>(payload, taskchain.at(t).period);
+		put<int32_t>(payload, taskchain.at(t).deadline);
+		put<int32_t>(payload, setofmk.at(t).mconsec);
+		put<int32_t>(payload, setofmk.at(t).mk.size());
+		for (int i = 0; i < setofmk.at(t).mk.size(); i++) {
+			put<int32_t>(payload, setofmk.at(t).mk.at(i).m);
+			put<int32_t>(payload, setofmk.at(t).mk.at(i).k);
+		}
+	}
+
+	write_block(STORE_CHAIN, 1, payload);
+	chains_written[h] = true;
+
+	return h;
+}
+
+
+void ResultsWriter::append(const StoreRecord &rec)
+{
+	bool full;
+	{
+		lock_guard<mutex> lock(write_mutex);
+		buffer.push_back(rec);
+		full = (buffer.size() >= batch_size);
+	}
+
+	if (full)
+		flush();
+}
+
+
+void ResultsWriter::flush()
+{
+	lock_guard<mutex> lock(write_mutex);
+
+	if (buffer.empty())
+		return;
+
+	const size_t n = buffer.size();
+	vector<char> payload;
+	payload.reserve(n * RECORD_BYTES);
+
+	for (size_t i = 0; i < n; i++) put<uint64_t>(payload, buffer.at(i).chain);
+	for (size_t i = 0; i < n; i++) put<int32_t>(payload, buffer.at(i).target);
+	for (size_t i = 0; i < n; i++) put<int32_t>(payload, buffer.at(i).m);
+	for (size_t i = 0; i < n; i++) put<int32_t>(payload, buffer.at(i).k);
+	for (size_t i = 0; i < n; i++) put<int32_t>(payload, buffer.at(i).status);
+	for (size_t i = 0; i < n; i++) put<double>(payload, buffer.at(i).objective);
+	for (size_t i = 0; i < n; i++) put<double>(payload, buffer.at(i).bound);
+	for (size_t i = 0; i < n; i++) put<double>(payload, buffer.at(i).runtime);
+
+	write_block(STORE_RECORDS, n, payload);
+	buffer.clear();
+}
+
+
+// Called with write_mutex held
+void ResultsWriter::write_block(uint32_t kind, uint32_t count, const vector<char> &payload)
+{
+	vector<char> block;
+	block.reserve(4 * sizeof(uint32_t) + payload.size());
+	put<uint32_t>(block, STORE_MAGIC);
+	put<uint32_t>(block, kind);
+	put<uint32_t>(block, count);
+	put<uint32_t>(block, payload.size());
+	block.insert(block.end(), payload.begin(), payload.end());
+
+	int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+	if (fd < 0) {
+		cerr << "[STORE] Cannot open " << path << endl;
+		return;
+	}
+
+	// One append per block, serialized with the other writers of the file
+	flock(fd, LOCK_EX);
+	const char *p = block.data();
+	size_t left = block.size();
+	while (left > 0) {
+		ssize_t n = write(fd, p, left);
+		if (n <= 0) {
+			cerr << "[STORE] Write error on " << path << endl;
+			break;
+		}
+		p += n;
+		left -= n;
+	}
+	flock(fd, LOCK_UN);
+	close(fd);
+}
+
+
+StoreRecord make_record(const vector<Task> &taskchain, const vector<WHconstr> &setofmk,
+	OptTarget mytarget, const MILPresult &res)
+{
+	StoreRecord rec;
+	rec.chain = chain_hash(taskchain, setofmk);
+	rec.target = mytarget;
+	rec.status = res.status;
+	rec.objective = res.objective;
+	rec.bound = res.bound;
+	rec.runtime = res.runtime;
+
+	// Hard chains are stored as (0,1)
+	rec.m = 0;
+	rec.k = 1;
+	for (int t = 0; t < setofmk.size(); t++) {
+		if (is_hard(setofmk.at(t)))
+			continue;
+		for (int i = 0; i < setofmk.at(t).mk.size(); i++) {
+			const MKconstr &mkc = setofmk.at(t).mk.at(i);
+			if (mkc.m * rec.k > rec.m * mkc.k) {
+				rec.m = mkc.m;
+				rec.k = mkc.k;
+			}
+		}
+	}
+
+	return rec;
+}
+
+
+//-----------------------------------------------------------------------------
+// READER
+//-----------------------------------------------------------------------------
+
+// Iterate over the complete blocks of the file. A trailing partial block (being written) is ignored.
+static bool for_each_block(const string &path, const function<void(uint32_t, uint32_t, const vector<char>&)> &visit)
+{
+	ifstream in(path, ios::binary);
+	if (!in.is_open())
+		return false;
+
+	vector<char> payload;
+	uint32_t header[4];
+
+	while (in.read(reinterpret_cast<char*>(header), sizeof(header))) {
+		if (header[0] != STORE_MAGIC) {
+			cerr << "[STORE] Corrupted block in " << path << endl;
+			return false;
+		}
+
+		payload.resize(header[3]);
+		if (!in.read(payload.data(), header[3]))
+			break;
+
+		visit(header[1], header[2], payload);
+	}
+
+	return true;
+}
+
+
+bool scan_store(const string &path, const StoreFilter &filter, const function<void(const StoreRecord&)> &visit)
+{
+	vector<size_t> selected;
+
+	return for_each_block(path, [&](uint32_t kind, uint32_t n, const vector<char> &payload) {
+
+		if (kind != STORE_RECORDS || payload.size() < n * RECORD_BYTES)
+			return;
+
+		// Column offsets
+		const char *base = payload.data();
+		const char *col_chain = base;
+		const char *col_target = col_chain + n * sizeof(uint64_t);
+		const char *col_m = col_target + n * sizeof(int32_t);
+		const char *col_k = col_m + n * sizeof(int32_t);
+		const char *col_status = col_k + n * sizeof(int32_t);
+		const char *col_obj = col_status + n * sizeof(int32_t);
+		const char *col_bound = col_obj + n * sizeof(double);
+		const char *col_runtime = col_bound + n * sizeof(double);
+
+		// Filter on the key columns first, then gather the selected rows
+		selected.clear();
+		for (size_t i = 0; i < n; i++) {
+			int32_t target, m, status;
+			memcpy(&target, col_target + i * sizeof(int32_t), sizeof(int32_t));
+			memcpy(&m, col_m + i * sizeof(int32_t), sizeof(int32_t));
+			memcpy(&status, col_status + i * sizeof(int32_t), sizeof(int32_t));
+
+			if (filter.target >= 0 && target != filter.target) continue;
+			if (filter.status >= 0 && status != filter.status) continue;
+			if (filter.min_m >= 0 && m < filter.min_m) continue;
+			if (filter.max_m >= 0 && m > filter.max_m) continue;
+			if (!filter.any_chain) {
+				uint64_t chain;
+				memcpy(&chain, col_chain + i * sizeof(uint64_t), sizeof(uint64_t));
+				if (chain != filter.chain) continue;
+			}
+			selected.push_back(i);
+		}
+
+		for (size_t s = 0; s < selected.size(); s++) {
+			size_t i = selected.at(s);
+			StoreRecord rec;
+			int32_t v;
+			memcpy(&rec.chain, col_chain + i * sizeof(uint64_t), sizeof(uint64_t));
+			memcpy(&v, col_target + i * sizeof(int32_t), sizeof(int32_t)); rec.target = v;
+			memcpy(&v, col_m + i * sizeof(int32_t), sizeof(int32_t)); rec.m = v;
+			memcpy(&v, col_k + i * sizeof(int32_t), sizeof(int32_t)); rec.k = v;
+			memcpy(&v, col_status + i * sizeof(int32_t), sizeof(int32_t)); rec.status = v;
+			memcpy(&rec.objective, col_obj + i * sizeof(double), sizeof(double));
+			memcpy(&rec.bound, col_bound + i * sizeof(double), sizeof(double));
+			memcpy(&rec.runtime, col_runtime + i * sizeof(double), sizeof(double));
+			visit(rec);
+		}
+	});
+}
+
+
+bool read_store_chains(const string &path, map<uint64_t, StoredChain> &chains)
+{
+	return for_each_block(path, [&](uint32_t kind, uint32_t, const vector<char> &payload) {
+
+		if (kind != STORE_CHAIN)
+			return;
+
+		// Counts come from the file: a damaged or foreign block is skipped, never read past its end
+		size_t pos = 0;
+		uint64_t h;
+		int32_t num_tasks;
+		if (!get(payload, pos, h) || !get(payload, pos, num_tasks) || num_tasks < 0)
+			return;
+
+		StoredChain sc;
+		for (int t = 0; t < num_tasks; t++) {
+			int32_t period, deadline, mconsec, num_mk;
+			if (!get(payload, pos, period) || !get(payload, pos, deadline) || !get(payload, pos, mconsec)
+				|| !get(payload, pos, num_mk) || num_mk < 0)
+				return;
+
+			Task task;
+			task.id = t;
+			task.period = period;
+			task.deadline = deadline;
+			sc.taskchain.push_back(task);
+
+			WHconstr whc;
+			whc.taskid = t;
+			whc.mconsec = mconsec;
+			for (int i = 0; i < num_mk; i++) {
+				MKconstr mkc;
+				int32_t m, k;
+				if (!get(payload, pos, m) || !get(payload, pos, k))
+					return;
+				mkc.m = m;
+				mkc.k = k;
+				whc.mk.push_back(mkc);
+			}
+			sc.setofmk.push_back(whc);
+		}
+
+		chains[h] = sc;
+	});
+}
+
+
+bool export_store_csv(const string &path, const StoreFilter &filter, ostream &out)
+{
+	out << "chain,target,m,k,status,objective,bound,runtime" << '\n';
+
+	return scan_store(path, filter, [&out](const StoreRecord &rec) {
+		out << hex << rec.chain << dec << ',' << rec.target << ',' << rec.m << ',' << rec.k << ','
+			<< rec.status << ',' << rec.objective << ',' << rec.bound << ',' << rec.runtime << '\n';
+	});
+}
@@ -0,0 +1,95 @@
+#ifndef MILP_STORE_H__
+#define MILP_STORE_H__
+
+#include <vector>
+#include <string>
+#include <map>
+#include <mutex>
+#include <functional>
+#include <iostream>
+#include <cstdint>
+
+#include "milp_data.h"
+
+//-----------------------------------------------------------------------------
+// Append-only columnar store of analysis results
+//
+// The file is a sequence of blocks, each one written with a single append under an
+// exclusive file lock, so several processes can share a store:
+//   header:  STORE_MAGIC, kind, count, payload bytes (uint32)
+//   records: count values of each column in turn (chain, target, m, k, status,
+//            objective, bound, runtime)
+//   chain:   chain hash, number of tasks, per task period, deadline, mconsec, number of (m,k)
+//            and the (m,k) pairs
+// Chains are stored once per writer, so each result can be traced back to its input.
+//-----------------------------------------------------------------------------
+
+#define STORE_MAGIC 0x53524857		// "WHRS"
+
+enum StoreBlockKind {
+	STORE_RECORDS = 1,
+	STORE_CHAIN = 2
+};
+
+struct StoreRecord {
+	uint64_t chain;		// chain_hash() of the analyzed chain
+	int target;			// OptTarget
+	int m;				// (m,k) of the most permissive weakly-hard task
+	int k;
+	int status;			// MILPstatus
+	double objective;
+	double bound;
+	double runtime;
+};
+
+struct StoredChain {
+	std::vector<Task> taskchain;
+	std::vector<WHconstr> setofmk;
+};
+
+// Records kept by a scan. Negative or empty fields match anything.
+struct StoreFilter {
+	uint64_t chain = 0;
+	bool any_chain = true;
+	int target = -1;
+	int status = -1;
+	int min_m = -1;
+	int max_m = -1;
+};
+
+class ResultsWriter {
+public:
+	// Records are buffered and appended in blocks of batch_size
+	ResultsWriter(const std::string &path, size_t batch_size = 4096);
+	~ResultsWriter();
+
+	// Store the chain (once) and return its hash
+	uint64_t add_chain(const std::vector<Task> &taskchain, const std::vector<WHconstr> &setofmk);
+
+	void append(const StoreRecord &rec);
+	void flush();
+
+private:
+	void write_block(uint32_t kind, uint32_t count, const std::vector<char> &payload);
+
+	std::string path;
+	size_t batch_size;
+	std::mutex write_mutex;
+	std::vector<StoreRecord> buffer;
+	std::map<uint64_t, bool> chains_written;
+};
+
+// Result of one analysis as a store record
+StoreRecord make_record(const std::vector<Task> &taskchain, const std::vector<WHconstr> &setofmk,
+	OptTarget mytarget, const MILPresult &res);
+
+// Visit the records matching the filter, in file order. Returns false if the file cannot be read.
+bool scan_store(const std::string &path, const StoreFilter &filter, const std::function<void(const StoreRecord&)> &visit);
+
+// All chains of the store, by hash
+bool read_store_chains(const std::string &path, std::map<uint64_t, StoredChain> &chains);
+
+// One CSV line per record matching the filter
+bool export_store_csv(const std::string &path, const StoreFilter &filter, std::ostream &out);
+
+#endif
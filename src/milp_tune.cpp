@@ -0,0 +1,308 @@
+#include "milp_tune.h"
+#include "milp_WHchain.h"
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+#define SGM_SHIFT 1.0			// seconds
+
+
+//-----------------------------------------------------------------------------
+// CLASSIFICATION
+//-----------------------------------------------------------------------------
+
+ChainFeatures chain_features(const vector<Task> &taskchain, const vector<WHconstr> &setofmk)
+{
+	ChainFeatures f;
+	const int N = taskchain.size();
+	f.length = N;
+
+	bool up = true, down = true;
+	int Tmin = 0, Tmax = 0;
+	for (int t = 0; t < N; t++) {
+		int T = taskchain.at(t).period;
+		Tmin = (t == 0) ? T : min(Tmin, T);
+		Tmax = (t == 0) ? T : max(Tmax, T);
+		if (t > 0) {
+			up = up && (T >= taskchain.at(t - 1).period);
+			down = down && (T <= taskchain.at(t - 1).period);
+		}
+	}
+	f.rule = up ? UN : (down ? OV : MX);
+	f.period_ratio = (Tmin > 0) ? (double)Tmax / Tmin : 1;
+
+	vector<int> periods;
+	for (int t = 0; t < N; t++)
+		periods.push_back(taskchain.at(t).period);
+	sort(periods.begin(), periods.end());
+	f.harmonic = true;
+	for (int t = 1; t < N; t++)
+		f.harmonic = f.harmonic && periods.at(t - 1) > 0 && periods.at(t) % periods.at(t - 1) == 0;
+
+	// Weakly-hard tasks and their thirds of the chain
+	f.miss_budget = 0;
+	bool thirds[3] = { false, false, false };
+	for (int t = 0; t < N && t < setofmk.size(); t++) {
+		const WHconstr &whc = setofmk.at(t);
+		double budget = (whc.mk.empty()) ? 1 : 0;
+		for (int i = 0; i < whc.mk.size(); i++) {
+			double r = (whc.mk.at(i).k > 0) ? (double)whc.mk.at(i).m / whc.mk.at(i).k : 0;
+			budget = (i == 0) ? r : min(budget, r);
+		}
+		if (whc.mconsec <= 0)
+			budget = 0;
+		if (budget > 0) {
+			f.miss_budget = max(f.miss_budget, budget);
+			if (t < N / 3)
+				thirds[0] = true;
+			else if (t < 2 * N / 3)
+				thirds[1] = true;
+			else
+				thirds[2] = true;
+		}
+	}
+
+	f.weakly_hard = thirds[0] || thirds[1] || thirds[2];
+	int num_thirds = thirds[0] + thirds[1] + thirds[2];
+	if (num_thirds != 1)
+		f.mktasks = MIX;
+	else
+		f.mktasks = thirds[0] ? TOP : (thirds[1] ? MID : BOT);
+
+	return f;
+}
+
+
+static const char* rule_name(PeriodsRule r)
+{
+	switch (r) {
+	case OV: return "OV";
+	case UN: return "UN";
+	default: return "MX";
+	}
+}
+
+
+static const char* mktasks_name(mkTasks m)
+{
+	switch (m) {
+	case TOP: return "TOP";
+	case MID: return "MID";
+	case BOT: return "BOT";
+	default: return "MIX";
+	}
+}
+
+
+string chain_class(const ChainFeatures &f)
+{
+	string key = rule_name(f.rule);
+	key += '.';
+	key += f.weakly_hard ? mktasks_name(f.mktasks) : "HARD";
+	key += '.';
+	key += (f.length <= 4) ? "S" : ((f.length <= 8) ? "M" : "L");
+	key += '.';
+	key += f.harmonic ? "H" : ((f.period_ratio <= 10) ? "R10" : "R100");
+	key += '.';
+	key += (f.miss_budget <= 0.2) ? "lo" : "hi";
+	return key;
+}
+
+
+//-----------------------------------------------------------------------------
+// PROFILES
+//-----------------------------------------------------------------------------
+
+void apply_profile(const MILPprofile &profile, MILPoptions &opts)
+{
+	opts.mipemphasis = profile.mipemphasis;
+	opts.cuts = profile.cuts;
+	opts.heurfreq = profile.heurfreq;
+	opts.branch_on = profile.branch_on;
+}
+
+
+bool MILPprofiles::load(const string &path)
+{
+	ifstream in(path);
+	if (!in.is_open())
+		return false;
+
+	string line;
+	while (getline(in, line)) {
+		if (line.empty() || line[0] == '#')
+			continue;
+
+		istringstream fields(line);
+		string key;
+		MILPprofile p;
+		int branch_on;
+		if (fields >> key >> p.mipemphasis >> p.cuts >> p.heurfreq >> branch_on >> p.score >> p.chains) {
+			p.branch_on = static_cast<BranchOn>(branch_on);
+			profiles[key] = p;
+		}
+	}
+	return true;
+}
+
+
+bool MILPprofiles::save(const string &path) const
+{
+	ofstream out(path);
+	if (!out.is_open())
+		return false;
+
+	out << "# class\tmipemphasis\tcuts\theurfreq\tbranch_on\tscore\tchains\n";
+	for (auto it = profiles.begin(); it != profiles.end(); ++it) {
+		const MILPprofile &p = it->second;
+		out << it->first << '\t' << p.mipemphasis << '\t' << p.cuts << '\t' << p.heurfreq << '\t'
+			<< (int)p.branch_on << '\t' << p.score << '\t' << p.chains << '\n';
+	}
+	return out.good();
+}
+
+
+const MILPprofile* MILPprofiles::find(const ChainFeatures &f) const
+{
+	const string key = chain_class(f);
+	auto exact = profiles.find(key);
+	if (exact != profiles.end())
+		return &exact->second;
+
+	// Class sharing most fields, earlier fields first, then the larger corpus
+	const MILPprofile *best = NULL;
+	int best_match = -1;
+	for (auto it = profiles.begin(); it != profiles.end(); ++it) {
+		istringstream a(key), b(it->first);
+		string fa, fb;
+		int match = 0, weight = 16;
+		while (getline(a, fa, '.') && getline(b, fb, '.')) {
+			if (fa == fb)
+				match += weight;
+			weight /= 2;
+		}
+		if (match > best_match || (match == best_match && it->second.chains > best->chains)) {
+			best = &it->second;
+			best_match = match;
+		}
+	}
+	return best;
+}
+
+
+MILPoptions select_profile(const MILPoptions &opts, const vector<Task> &taskchain, const vector<WHconstr> &setofmk)
+{
+	MILPoptions selected = opts;
+	if (opts.profiles != NULL) {
+		const MILPprofile *p = opts.profiles->find(chain_features(taskchain, setofmk));
+		if (p != NULL)
+			apply_profile(*p, selected);
+	}
+	return selected;
+}
+
+
+//-----------------------------------------------------------------------------
+// TUNING
+//-----------------------------------------------------------------------------
+
+// Cost of a run, in seconds
+static double run_cost(const MILPresult &res, double timelimit)
+{
+	switch (res.status) {
+	case MILP_OPTIMAL:
+	case MILP_INFEASIBLE:
+		return res.runtime;
+	case MILP_FEASIBLE: {
+		double gap = (res.objective != 0) ? fabs(res.bound - res.objective) / fabs(res.objective) : 1;
+		return timelimit * (1 + min(gap, 1.0));
+	}
+	default:
+		return 2 * timelimit;
+	}
+}
+
+
+static double evaluate(const vector<TuneChain> &corpus, const TuneOptions &topts, const MILPprofile &profile)
+{
+	MILPoptions opts = topts.milp;
+	opts.profiles = NULL;
+	opts.race = NULL;
+	opts.verbose = false;
+	opts.export_model.clear();
+	opts.results_file.clear();
+	apply_profile(profile, opts);
+
+	double log_sum = 0;
+	int runs = 0;
+	for (int c = 0; c < corpus.size(); c++) {
+		for (int i = 0; i < topts.targets.size(); i++) {
+			MILPresult res = MILP_WH_K(corpus.at(c).taskchain, corpus.at(c).setofmk, topts.targets.at(i), opts);
+			log_sum += log(run_cost(res, opts.timelimit) + SGM_SHIFT);
+			runs++;
+		}
+	}
+
+	return (runs > 0) ? exp(log_sum / runs) - SGM_SHIFT : 0;
+}
+
+
+MILPprofile tune_class(const vector<TuneChain> &corpus, const TuneOptions &topts)
+{
+	// Values tried for each parameter
+	const vector<int> emphasis = { 0, 1, 2, 3, 4 };
+	const vector<int> cuts = { 0, -1, 1, 2 };
+	const vector<int> heurfreq = { 0, -1, 10, 50 };
+	const vector<int> branch_on = { BRANCH_DEFAULT, BRANCH_LENGTHK, BRANCH_EFFECTIVEJOB };
+
+	MILPprofile best;
+	best.mipemphasis = topts.milp.mipemphasis;
+	best.cuts = topts.milp.cuts;
+	best.heurfreq = topts.milp.heurfreq;
+	best.branch_on = topts.milp.branch_on;
+	best.chains = corpus.size();
+	best.score = evaluate(corpus, topts, best);
+	int evals = 1;
+
+	if (topts.verbose)
+		cout << "tune: start " << best.score << endl;
+
+	bool improved = true;
+	while (improved && evals < topts.max_evals) {
+		improved = false;
+
+		for (int param = 0; param < 4 && evals < topts.max_evals; param++) {
+			const vector<int> &values = (param == 0) ? emphasis : (param == 1) ? cuts : (param == 2) ? heurfreq : branch_on;
+
+			for (int v = 0; v < values.size() && evals < topts.max_evals; v++) {
+				MILPprofile cand = best;
+				switch (param) {
+				case 0: cand.mipemphasis = values.at(v); break;
+				case 1: cand.cuts = values.at(v); break;
+				case 2: cand.heurfreq = values.at(v); break;
+				case 3: cand.branch_on = static_cast<BranchOn>(values.at(v)); break;
+				}
+				if (cand.mipemphasis == best.mipemphasis && cand.cuts == best.cuts &&
+					cand.heurfreq == best.heurfreq && cand.branch_on == best.branch_on)
+					continue;
+
+				cand.score = evaluate(corpus, topts, cand);
+				evals++;
+
+				if (cand.score < best.score) {
+					best = cand;
+					improved = true;
+					if (topts.verbose)
+						cout << "tune: emphasis " << best.mipemphasis << " cuts " << best.cuts << " heurfreq "
+							<< best.heurfreq << " branch " << (int)best.branch_on << " -> " << best.score << endl;
+				}
+			}
+		}
+	}
+
+	return best;
+}
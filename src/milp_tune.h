@@ -0,0 +1,84 @@
+#ifndef MILP_TUNE_H__
+#define MILP_TUNE_H__
+
+#include <vector>
+#include <string>
+#include <map>
+
+#include "milp_data.h"
+
+//-----------------------------------------------------------------------------
+// Solver parameter profiles per class of chains
+//
+// Chains are classified by the order of their periods (PeriodsRule), the position of their
+// weakly-hard tasks (mkTasks), their length, the ratios of their periods and their miss budget. Profiles are tuned offline
+// on a corpus (tune_class, src/tune_main.cpp), persisted in a tab-separated file and selected
+// by MILP_WH_K when MILPoptions::profiles is set.
+//-----------------------------------------------------------------------------
+
+struct ChainFeatures {
+	int length;
+	PeriodsRule rule;			// UN: non-decreasing periods, OV: non-increasing, MX: otherwise
+	mkTasks mktasks;			// where the weakly-hard tasks are (MIX also if there is none)
+	bool weakly_hard;			// at least one task may miss a deadline
+	double period_ratio;		// largest over smallest period
+	bool harmonic;				// every period divides the next larger one
+	double miss_budget;			// largest m/k over the tasks
+};
+
+ChainFeatures chain_features(const std::vector<Task> &taskchain, const std::vector<WHconstr> &setofmk);
+
+// Class of a chain, e.g. "UN.TOP.S.H.lo": rule, weakly-hard tasks (HARD if none), length S/M/L,
+// periods harmonic H or with ratio up to 10 R10 or above R100, miss budget lo/hi
+std::string chain_class(const ChainFeatures &f);
+
+struct MILPprofile {
+	int mipemphasis = 0;
+	int cuts = 0;
+	int heurfreq = 0;
+	BranchOn branch_on = BRANCH_DEFAULT;
+	double score = 0;			// shifted geometric mean of the runtimes on the corpus (seconds)
+	int chains = 0;				// size of the corpus of the class
+};
+
+void apply_profile(const MILPprofile &profile, MILPoptions &opts);
+
+class MILPprofiles {
+public:
+	// False if the file cannot be read; malformed lines are skipped
+	bool load(const std::string &path);
+	bool save(const std::string &path) const;
+
+	void set(const std::string &chainclass, const MILPprofile &profile) { profiles[chainclass] = profile; }
+
+	// Profile of the class of the chain, or of the class sharing most of its fields. NULL if empty.
+	const MILPprofile* find(const ChainFeatures &f) const;
+
+	size_t size() const { return profiles.size(); }
+
+private:
+	std::map<std::string, MILPprofile> profiles;
+};
+
+// Copy of opts with the profile of the chain applied, if opts has profiles
+MILPoptions select_profile(const MILPoptions &opts, const std::vector<Task> &taskchain,
+	const std::vector<WHconstr> &setofmk);
+
+struct TuneChain {
+	std::vector<Task> taskchain;
+	std::vector<WHconstr> setofmk;
+};
+
+struct TuneOptions {
+	std::vector<OptTarget> targets = { MAXIMIZE_LATENCY, MAXIMIZE_DATAAGE, MAXIMIZE_UPDATE_INT, MINIMIZE_UPDATE_INT };
+	int max_evals = 40;			// settings evaluated on the whole corpus
+	MILPoptions milp;			// settings not being tuned, timelimit of each run included
+	bool verbose = false;
+};
+
+// Local search over the solver settings, one parameter at a time, minimizing the shifted geometric
+// mean of the runtimes on the corpus. Runs not proved optimal count as the time limit times (1 + gap),
+// runs without solution as twice the time limit.
+MILPprofile tune_class(const std::vector<TuneChain> &corpus, const TuneOptions &topts);
+
+#endif
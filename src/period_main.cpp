@@ -0,0 +1,67 @@
+#include "milp_periods.h"
+#include "chain_gen.h"
+#include <iostream>
+#include <thread>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+// Periods every task may take (automotive standard, ms), as in the random mode of main.cpp
+static const int PERIOD_BUCKET[] = { 1, 2, 5, 10, 20, 25, 50, 100 };
+
+// Usage: whperiods chain_file m k [latency|dataage] [util_cap] [wcet] [workers] [max_evals] [timelimit]
+// (m,k) and mconsec = m are given to the weakly-hard tasks of the chain file. Every task gets the same
+// wcet (ms) on a single core, and may take any period of the bucket; deadlines are implicit.
+int main(int argc, char *argv[])
+{
+	if (argc < 4) {
+		cerr << "Usage: whperiods chain_file m k [latency|dataage] [util_cap] [wcet] [workers] [max_evals] [timelimit]" << endl;
+		return EXIT_FAILURE;
+	}
+
+	vector<Task> taskchain;
+	vector<WHconstr> setofmk;
+	vector<int> mktaskid;
+	if (!read_chain_file(argv[1], taskchain, setofmk, mktaskid)) {
+		cerr << "[PERIODS] Cannot read " << argv[1] << endl;
+		return EXIT_FAILURE;
+	}
+	set_weakly_hard(setofmk, mktaskid, atoi(argv[2]), atoi(argv[3]));
+
+	OptTarget mytarget = (argc > 4 && strcmp(argv[4], "dataage") == 0) ? MAXIMIZE_DATAAGE : MAXIMIZE_LATENCY;
+
+	PeriodSearchOptions popts;
+	popts.util_cap = (argc > 5) ? atof(argv[5]) : 1.0;
+	int wcet = (argc > 6) ? atoi(argv[6]) : 0;
+	popts.workers = (argc > 7) ? atoi(argv[7]) : max(1u, thread::hardware_concurrency());
+	popts.max_evals = (argc > 8) ? atoll(argv[8]) : 0;
+	popts.milp.timelimit = (argc > 9) ? atof(argv[9]) : 60;
+	popts.milp.threads = 1;
+	popts.verbose = true;
+
+	const vector<int> bucket(PERIOD_BUCKET, PERIOD_BUCKET + sizeof(PERIOD_BUCKET) / sizeof(PERIOD_BUCKET[0]));
+	for (int t = 0; t < taskchain.size(); t++) {
+		taskchain.at(t).wcet = wcet;
+		popts.allowed.push_back(bucket);
+	}
+
+	PeriodSearchResult res = optimize_periods(taskchain, setofmk, mytarget, popts);
+
+	cerr << "[PERIODS] " << res.nodes << " nodes, " << res.pruned_util << " over the cap, " << res.pruned_bound
+		<< " pruned by bound, " << res.evaluated << " analyses, " << res.rejected << " without solution, "
+		<< res.runtime << " s" << endl;
+
+	if (res.periods.empty()) {
+		cerr << "[PERIODS] " << res.message << endl;
+		return EXIT_FAILURE;
+	}
+
+	cout << "task,period\n";
+	for (int t = 0; t < taskchain.size(); t++)
+		cout << taskchain.at(t).id << ',' << res.periods.at(t) << '\n';
+	cout << (mytarget == MAXIMIZE_DATAAGE ? "dataage," : "latency,") << res.best.bound << '\n';
+	cout << "status," << res.status << '\n';
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,49 @@
+#include "wh_sim.h"
+#include "chain_gen.h"
+#include <iostream>
+#include <cstdlib>
+
+using namespace std;
+
+static void print_histogram(const char *metric, const Histogram &h)
+{
+	cout << metric << ',' << h.count() << ',' << h.mean() << ',' << h.min() << ',' << h.percentile(0.5) << ','
+		<< h.percentile(0.9) << ',' << h.percentile(0.99) << ',' << h.percentile(0.999) << ',' << h.max() << '\n';
+}
+
+// Usage: whsim chain_file m k [runs] [p_miss] [markov]
+// (m,k) and mconsec = m are given to the weakly-hard tasks of the chain file
+int main(int argc, char *argv[])
+{
+	if (argc < 4) {
+		cerr << "Usage: whsim chain_file m k [runs] [p_miss] [markov]" << endl;
+		return EXIT_FAILURE;
+	}
+
+	vector<Task> taskchain;
+	vector<WHconstr> setofmk;
+	vector<int> mktaskid;
+	if (!read_chain_file(argv[1], taskchain, setofmk, mktaskid)) {
+		cerr << "[SIM] Cannot read " << argv[1] << endl;
+		return EXIT_FAILURE;
+	}
+	set_weakly_hard(setofmk, mktaskid, atoi(argv[2]), atoi(argv[3]));
+
+	SimOptions sopts;
+	if (argc > 4)
+		sopts.runs = atoll(argv[4]);
+	if (argc > 5)
+		sopts.miss.p_miss = atof(argv[5]);
+	if (argc > 6 && atoi(argv[6]))
+		sopts.miss.process = MISS_MARKOV;
+
+	SimResult res = simulate_chain(taskchain, setofmk, sopts);
+
+	cout << "metric,samples,mean,min,p50,p90,p99,p999,max\n";
+	print_histogram("latency", res.latency);
+	print_histogram("dataage", res.dataage);
+	print_histogram("updateint", res.updateint);
+
+	cerr << "[SIM] " << res.activations << " job activations in " << res.runtime << " s" << endl;
+	return EXIT_SUCCESS;
+}
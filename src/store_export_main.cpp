@@ -0,0 +1,34 @@
+#include "milp_store.h"
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+
+using namespace std;
+
+// Usage: whstore_export store_file [output.csv] [target]
+int main(int argc, char *argv[])
+{
+	if (argc < 2) {
+		cerr << "Usage: " << argv[0] << " store_file [output.csv] [target]" << endl;
+		return EXIT_FAILURE;
+	}
+
+	StoreFilter filter;
+	if (argc > 3)
+		filter.target = atoi(argv[3]);
+
+	bool ok;
+	if (argc > 2) {
+		ofstream out(argv[2]);
+		ok = export_store_csv(argv[1], filter, out);
+	}
+	else {
+		ok = export_store_csv(argv[1], filter, cout);
+	}
+
+	if (!ok) {
+		cerr << "Cannot read " << argv[1] << endl;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
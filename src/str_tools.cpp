@@ -8,4 +8,38 @@ std::string  convert_to_string(const int Number) {
 
 	std::string Result = "_" + convert.str();
 	return Result;
-}
\ No newline at end of file
+}
+
+// FNV-1a over the fields that define the analysis problem
+static void hash_int(uint64_t &h, const int value) {
+
+	uint32_t v = static_cast<uint32_t>(value);
+
+	for (int b = 0; b < 4; b++) {
+		h ^= (v >> (8 * b)) & 0xFF;
+		h *= 1099511628211ULL;
+	}
+}
+
+uint64_t chain_hash(const std::vector<Task> &taskchain, const std::vector<WHconstr> &setofmk) {
+
+	uint64_t h = 14695981039346656037ULL;
+
+	hash_int(h, taskchain.size());
+	for (int t = 0; t < taskchain.size(); t++) {
+		hash_int(h, taskchain.at(t).period);
+		hash_int(h, taskchain.at(t).deadline);
+	}
+
+	hash_int(h, setofmk.size());
+	for (int t = 0; t < setofmk.size(); t++) {
+		hash_int(h, setofmk.at(t).mconsec);
+		hash_int(h, setofmk.at(t).mk.size());
+		for (int i = 0; i < setofmk.at(t).mk.size(); i++) {
+			hash_int(h, setofmk.at(t).mk.at(i).m);
+			hash_int(h, setofmk.at(t).mk.at(i).k);
+		}
+	}
+
+	return h;
+}
@@ -0,0 +1,76 @@
+#include "milp_tune.h"
+#include "chain_gen.h"
+#include <iostream>
+#include <map>
+#include <random>
+#include <cstdlib>
+
+using namespace std;
+
+// Values of m given to the weakly-hard tasks of the perceptin chains (k = 50, as in main.cpp)
+static const int PERCEPTIN_M[] = { 0, 2, 5, 10, 20 };
+
+// Usage: whtune [profiles_file] [synthetic_per_class] [seed] [timelimit] [max_evals]
+int main(int argc, char *argv[])
+{
+	string path = (argc > 1) ? argv[1] : "profiles.tsv";
+	int per_class = (argc > 2) ? atoi(argv[2]) : 4;
+	unsigned seed = (argc > 3) ? atoi(argv[3]) : 1;
+
+	TuneOptions topts;
+	topts.milp.timelimit = (argc > 4) ? atof(argv[4]) : 60;
+	topts.max_evals = (argc > 5) ? atoi(argv[5]) : 40;
+	topts.verbose = true;
+
+	// Corpus, grouped by class of chains
+	map<string, vector<TuneChain> > corpus;
+
+	for (int c = 1; c <= 5; c++) {
+		TuneChain ch;
+		vector<int> mktaskid;
+		if (!read_chain_file("perceptin" + to_string(c) + ".txt", ch.taskchain, ch.setofmk, mktaskid)) {
+			cerr << "[TUNE] Cannot read perceptin" << c << ".txt" << endl;
+			continue;
+		}
+		for (int i = 0; i < sizeof(PERCEPTIN_M) / sizeof(PERCEPTIN_M[0]); i++) {
+			set_weakly_hard(ch.setofmk, mktaskid, PERCEPTIN_M[i], 50);
+			corpus[chain_class(chain_features(ch.taskchain, ch.setofmk))].push_back(ch);
+		}
+	}
+
+	// Seeded synthetic chains for every period rule and placement of the weakly-hard tasks
+	mt19937 rng(seed);
+	for (int rule = OV; rule <= MX; rule++) {
+		for (int mk = TOP; mk <= MIX; mk++) {
+			for (int n = 3; n <= 9; n += 3) {
+				ChainGenParams params;
+				params.num_tasks = n;
+				params.rule = static_cast<PeriodsRule>(rule);
+				params.mktasks = static_cast<mkTasks>(mk);
+				for (int s = 0; s < per_class; s++) {
+					TuneChain ch;
+					random_chain(rng, params, ch.taskchain, ch.setofmk);
+					corpus[chain_class(chain_features(ch.taskchain, ch.setofmk))].push_back(ch);
+				}
+			}
+		}
+	}
+
+	// Tune the classes one after the other, saving as we go
+	MILPprofiles profiles;
+	profiles.load(path);
+
+	for (auto it = corpus.begin(); it != corpus.end(); ++it) {
+		cout << "[TUNE] Class " << it->first << ": " << it->second.size() << " chains" << endl;
+		MILPprofile best = tune_class(it->second, topts);
+		profiles.set(it->first, best);
+
+		if (!profiles.save(path)) {
+			cerr << "[TUNE] Cannot write " << path << endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	cout << "[TUNE] " << profiles.size() << " profiles in " << path << endl;
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,310 @@
+#include "wh_automaton.h"
+#include "milp_presolve.h"
+
+#include <map>
+#include <deque>
+#include <limits>
+#include <stdexcept>
+
+using namespace std;
+
+
+//-----------------------------------------------------------------------------
+// CONSTRUCTION
+//-----------------------------------------------------------------------------
+
+WHautomaton::WHautomaton(const WHconstr &input, int max_states)
+{
+	const WHconstr whc = normalize_whconstr(input);
+
+	// Outcomes remembered in a state: the last K-1, K being the largest window
+	int K = 1;
+	for (int i = 0; i < whc.mk.size(); i++)
+		K = max(K, whc.mk.at(i).k);
+	if (K > 64)
+		throw length_error("WHautomaton: k larger than 64");
+
+	const int W = K - 1;
+	const uint64_t window_mask = (W == 0) ? 0 : (~0ULL >> (64 - W));
+
+	// States are (window, current run of misses), discovered breadth first
+	map<pair<uint64_t, int>, int> index;
+	deque<pair<uint64_t, int> > frontier;
+
+	index[make_pair(0ULL, 0)] = 0;
+	frontier.push_back(make_pair(0ULL, 0));
+	trans.assign(2, WH_DEAD_STATE);
+
+	while (!frontier.empty()) {
+
+		pair<uint64_t, int> st = frontier.front();
+		frontier.pop_front();
+		int from = index[st];
+
+		for (int miss = 0; miss <= 1; miss++) {
+
+			// Last K outcomes, most recent in bit 0
+			uint64_t full = (W == 0) ? miss : ((st.first << 1) | miss);
+			int run = miss ? st.second + 1 : 0;
+
+			bool ok = (run <= whc.mconsec);
+			for (int i = 0; ok && i < whc.mk.size(); i++) {
+				int k = whc.mk.at(i).k;
+				uint64_t last_k = (k == 64) ? full : (full & ((1ULL << k) - 1));
+				ok = (__builtin_popcountll(last_k) <= whc.mk.at(i).m);
+			}
+			if (!ok)
+				continue;
+
+			pair<uint64_t, int> succ = make_pair(full & window_mask, run);
+			auto it = index.find(succ);
+			int to;
+			if (it == index.end()) {
+				to = index.size();
+				if (to >= max_states)
+					throw length_error("WHautomaton: too many states");
+				index[succ] = to;
+				frontier.push_back(succ);
+				trans.push_back(WH_DEAD_STATE);
+				trans.push_back(WH_DEAD_STATE);
+			}
+			else {
+				to = it->second;
+			}
+			trans[2 * from + miss] = to;
+		}
+	}
+
+	minimize();
+}
+
+
+// Moore partition refinement. All states accept, so states are told apart only by
+// how soon (and after which outcomes) they reach the dead state.
+void WHautomaton::minimize()
+{
+	const int n = num_states();
+	vector<int> block(n, 0);
+	int num_blocks = 1;
+
+	while (true) {
+		map<pair<int, pair<int, int> >, int> signature;
+		vector<int> refined(n);
+
+		for (int s = 0; s < n; s++) {
+			int h = trans[2 * s], m = trans[2 * s + 1];
+			pair<int, pair<int, int> > sig = make_pair(block[s],
+				make_pair(h < 0 ? -1 : block[h], m < 0 ? -1 : block[m]));
+			auto it = signature.find(sig);
+			if (it == signature.end()) {
+				int id = signature.size();
+				signature[sig] = id;
+				refined[s] = id;
+			}
+			else {
+				refined[s] = it->second;
+			}
+		}
+
+		bool stable = (signature.size() == num_blocks);
+		block = refined;
+		num_blocks = signature.size();
+		if (stable)
+			break;
+	}
+
+	// Renumber so that the block of the initial state is 0 (it is, as state 0 is visited first)
+	vector<int> minimized(2 * num_blocks, WH_DEAD_STATE);
+	for (int s = 0; s < n; s++) {
+		int h = trans[2 * s], m = trans[2 * s + 1];
+		minimized[2 * block[s]] = (h < 0) ? WH_DEAD_STATE : block[h];
+		minimized[2 * block[s] + 1] = (m < 0) ? WH_DEAD_STATE : block[m];
+	}
+	trans.swap(minimized);
+}
+
+
+//-----------------------------------------------------------------------------
+// QUERIES
+//-----------------------------------------------------------------------------
+
+bool WHautomaton::accepts(const vector<bool> &seq) const
+{
+	int s = initial();
+	for (int i = 0; i < seq.size() && s >= 0; i++)
+		s = next(s, seq[i]);
+
+	return s >= 0;
+}
+
+
+double WHautomaton::count(int n) const
+{
+	vector<double> ways(num_states(), 0.0), succ(num_states());
+	ways[initial()] = 1.0;
+
+	for (int step = 0; step < n; step++) {
+		fill(succ.begin(), succ.end(), 0.0);
+		for (int s = 0; s < num_states(); s++) {
+			if (ways[s] == 0.0)
+				continue;
+			for (int miss = 0; miss <= 1; miss++) {
+				int to = next(s, miss);
+				if (to >= 0)
+					succ[to] += ways[s];
+			}
+		}
+		ways.swap(succ);
+	}
+
+	double total = 0;
+	for (int s = 0; s < num_states(); s++)
+		total += ways[s];
+	return total;
+}
+
+
+// best[l][s]: largest number of misses in l more outcomes from state s (-1 if none is admissible)
+static vector<vector<int> > misses_to_go(const WHautomaton &dfa, int n)
+{
+	vector<vector<int> > best(n + 1, vector<int>(dfa.num_states(), -1));
+	fill(best[0].begin(), best[0].end(), 0);
+
+	for (int l = 1; l <= n; l++) {
+		for (int s = 0; s < dfa.num_states(); s++) {
+			int h = dfa.next(s, false), m = dfa.next(s, true);
+			if (h >= 0 && best[l - 1][h] >= 0)
+				best[l][s] = max(best[l][s], best[l - 1][h]);
+			if (m >= 0 && best[l - 1][m] >= 0)
+				best[l][s] = max(best[l][s], best[l - 1][m] + 1);
+		}
+	}
+	return best;
+}
+
+
+int WHautomaton::max_misses(int n) const
+{
+	return misses_to_go(*this, n)[n][initial()];
+}
+
+
+void WHautomaton::worst_case_windows(int n, const function<void(const vector<bool>&)> &visit, size_t limit) const
+{
+	vector<vector<int> > best = misses_to_go(*this, n);
+	vector<bool> seq(n);
+	size_t visited = 0;
+
+	// Depth-first, following only outcomes that keep the worst case reachable
+	function<void(int, int)> dfs = [&](int pos, int s) {
+		if (visited >= limit)
+			return;
+		if (pos == n) {
+			visit(seq);
+			visited++;
+			return;
+		}
+		int left = n - pos;
+		for (int miss = 1; miss >= 0; miss--) {
+			int to = next(s, miss);
+			if (to >= 0 && best[left - 1][to] >= 0 && best[left - 1][to] + miss == best[left][s]) {
+				seq[pos] = miss;
+				dfs(pos + 1, to);
+			}
+		}
+	};
+
+	if (best[n][initial()] >= 0)
+		dfs(0, initial());
+}
+
+
+void WHautomaton::enumerate(int n, const function<void(const vector<bool>&)> &visit, size_t limit) const
+{
+	vector<bool> seq(n);
+	size_t visited = 0;
+
+	function<void(int, int)> dfs = [&](int pos, int s) {
+		if (visited >= limit)
+			return;
+		if (pos == n) {
+			visit(seq);
+			visited++;
+			return;
+		}
+		for (int miss = 0; miss <= 1; miss++) {
+			int to = next(s, miss);
+			if (to >= 0) {
+				seq[pos] = miss;
+				dfs(pos + 1, to);
+			}
+		}
+	};
+
+	dfs(0, initial());
+}
+
+
+//-----------------------------------------------------------------------------
+// BIT-SLICED BATCH CHECK
+//-----------------------------------------------------------------------------
+
+// The state of every lane is kept in bit planes (bit b of the state of lane j in bit j of plane b).
+// At each step the lanes are grouped by state, taking the state of the lowest lane not yet moved:
+// a step costs one pass over the planes per distinct state among the 64 lanes, whatever the size
+// of the automaton.
+uint64_t WHautomaton::admissible_lanes(const uint64_t *steps, size_t n) const
+{
+	int bits = 1;
+	while ((1LL << bits) < num_states())
+		bits++;
+
+	vector<uint64_t> plane(bits, 0), succ(bits);
+	uint64_t alive = ~0ULL;	// lanes not in the dead state; all start in the initial state 0
+
+	for (size_t t = 0; t < n && alive; t++) {
+		fill(succ.begin(), succ.end(), 0);
+		uint64_t succ_alive = 0;
+
+		uint64_t todo = alive;
+		while (todo) {
+			const int lane = __builtin_ctzll(todo);
+
+			// State of the lane, and the lanes in the same state
+			int s = 0;
+			uint64_t same = todo;
+			for (int b = 0; b < bits; b++) {
+				if ((plane[b] >> lane) & 1) {
+					s |= 1 << b;
+					same &= plane[b];
+				}
+				else {
+					same &= ~plane[b];
+				}
+			}
+			todo &= ~same;
+
+			for (int miss = 0; miss <= 1; miss++) {
+				const int to = next(s, miss);
+				const uint64_t lanes = same & (miss ? steps[t] : ~steps[t]);
+				if (to < 0 || !lanes)
+					continue;
+				succ_alive |= lanes;
+				for (int b = 0; b < bits; b++)
+					if ((to >> b) & 1)
+						succ[b] |= lanes;
+			}
+		}
+
+		plane.swap(succ);
+		alive = succ_alive;
+	}
+
+	return alive;
+}
+
+
+uint64_t admissible_lanes(const WHconstr &whc, const uint64_t *steps, size_t n)
+{
+	return WHautomaton(whc).admissible_lanes(steps, n);
+}
@@ -0,0 +1,65 @@
+#ifndef WH_AUTOMATON_H__
+#define WH_AUTOMATON_H__
+
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+#include "milp_data.h"
+
+//-----------------------------------------------------------------------------
+// Hit/miss sequences admitted by a weakly-hard constraint
+//
+// WHautomaton compiles all the (m,k) pairs and mconsec of a WHconstr into the minimal DFA over
+// {hit, miss}. Every state is accepting, violations go to the implicit dead state -1.
+// Sequences start after an arbitrary long run of hits.
+// The automaton is the only definition of admissibility in this module: every query, the
+// bit-sliced batch check included, steps its transitions.
+//-----------------------------------------------------------------------------
+
+#define WH_DEAD_STATE -1
+
+class WHautomaton {
+public:
+	// Throws std::length_error if the automaton before minimization exceeds max_states
+	// (the window of the largest k is tracked explicitly, so k must be at most 64)
+	explicit WHautomaton(const WHconstr &whc, int max_states = 1 << 20);
+
+	int num_states() const { return trans.size() / 2; }
+	int initial() const { return 0; }
+
+	// State after a hit (miss = false) or a miss (miss = true), WH_DEAD_STATE once violated
+	int next(int state, bool miss) const {
+		return (state < 0) ? WH_DEAD_STATE : trans[2 * state + (miss ? 1 : 0)];
+	}
+
+	// Sequence given as outcomes, true = miss
+	bool accepts(const std::vector<bool> &seq) const;
+
+	// Number of admissible sequences of length n
+	double count(int n) const;
+
+	// Largest number of misses in an admissible sequence of length n
+	int max_misses(int n) const;
+
+	// Visit up to limit admissible sequences of length n with max_misses(n) misses
+	void worst_case_windows(int n, const std::function<void(const std::vector<bool>&)> &visit, size_t limit) const;
+
+	// Visit up to limit admissible sequences of length n
+	void enumerate(int n, const std::function<void(const std::vector<bool>&)> &visit, size_t limit) const;
+
+	// Bit-sliced check of 64 sequences at once: bit j of steps[t] is the outcome of sequence j at
+	// step t (1 = miss). Returns the lanes whose sequence the automaton accepts.
+	uint64_t admissible_lanes(const uint64_t *steps, size_t n) const;
+
+private:
+	void minimize();
+
+	std::vector<int> trans;		// two entries per state: after hit, after miss
+};
+
+// Compiles the constraint and runs WHautomaton::admissible_lanes: compile once and keep the
+// automaton for repeated checks of the same constraint. Throws as the constructor of WHautomaton
+uint64_t admissible_lanes(const WHconstr &whc, const uint64_t *steps, size_t n);
+
+#endif
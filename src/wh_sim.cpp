@@ -0,0 +1,306 @@
+#include "wh_sim.h"
+#include "wh_automaton.h"
+
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+
+using namespace std;
+
+#define NO_DATA -1.0
+
+// Jobs of the fastest task simulated per time segment
+#define SIM_SEGMENT_JOBS 1024
+
+
+//-----------------------------------------------------------------------------
+// HISTOGRAM
+//-----------------------------------------------------------------------------
+
+void Histogram::merge(const Histogram &other)
+{
+	if (other.samples == 0)
+		return;
+	if (other.counts.size() > counts.size())
+		counts.resize(other.counts.size(), 0);
+	for (size_t i = 0; i < other.counts.size(); i++)
+		counts[i] += other.counts[i];
+	lo = (samples == 0) ? other.lo : std::min(lo, other.lo);
+	hi = (samples == 0) ? other.hi : std::max(hi, other.hi);
+	sum += other.sum;
+	samples += other.samples;
+}
+
+
+double Histogram::percentile(double q) const
+{
+	if (samples == 0)
+		return 0;
+	uint64_t rank = (uint64_t)ceil(q * samples);
+	if (rank < 1)
+		rank = 1;
+	uint64_t seen = 0;
+	for (size_t i = 0; i < counts.size(); i++) {
+		seen += counts[i];
+		if (seen >= rank)
+			return std::min(hi, (i + 1) * width);
+	}
+	return hi;
+}
+
+
+//-----------------------------------------------------------------------------
+// LANES
+//-----------------------------------------------------------------------------
+
+// splitmix64, one state per lane
+static inline double uniform(uint64_t &state)
+{
+	uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	z ^= z >> 31;
+	return (z >> 11) * (1.0 / 9007199254740992.0);
+}
+
+
+// Per task state of a batch. Job rows are lane-minor: row r of lane l is job first[l] + r.
+struct TaskLanes {
+	vector<double> offset;		// [lane]
+	vector<int> dfa;			// [lane] state of the WHautomaton
+	vector<uint8_t> bad;		// [lane] state of the Markov chain
+	vector<double> carry;		// [lane] data held before the first job of the segment
+	vector<double> held;		// [lane] data held after the last job so far
+	vector<long long> first;	// [lane] first job of the segment
+	vector<double> out;			// [row * SIM_LANES + lane] data held after the job (head release time)
+};
+
+
+struct Histograms {
+	Histogram latency, dataage, updateint;
+	uint64_t activations;
+
+	explicit Histograms(double w) : latency(w), dataage(w), updateint(w), activations(0) {}
+};
+
+
+// The chain is simulated one time segment after the other. Task t handles the jobs released in
+// [S0 - shift[t], S1 - shift[t]), shift[t-1] = shift[t] + D[t-1]: the jobs its consumer may read
+// are all in its own segment, or held in carry.
+static void simulate_batch(const vector<Task> &taskchain, const vector<WHautomaton> &dfa,
+	const vector<MissModel> &miss, const vector<bool> &hard, double horizon, double warmup,
+	double segment, uint64_t seed, int lanes, Histograms &h)
+{
+	const int N = taskchain.size();
+	const int W = SIM_LANES;
+
+	vector<uint64_t> rng(W);
+	for (int l = 0; l < W; l++)
+		rng[l] = seed ^ (0xD1B54A32D192ED03ULL * (l + 1));
+	vector<uint8_t> missed(W), valid(W);
+
+	vector<double> shift(N, 0.0);
+	for (int t = N - 1; t > 0; t--)
+		shift[t - 1] = shift[t] + taskchain.at(t - 1).deadline;
+
+	vector<TaskLanes> task(N);
+	for (int t = 0; t < N; t++) {
+		TaskLanes &tl = task[t];
+		const int rows = (int)ceil(segment / taskchain.at(t).period) + 1;
+		tl.offset.assign(W, 0.0);
+		if (t > 0)
+			for (int l = 0; l < W; l++)
+				tl.offset[l] = uniform(rng[l]) * taskchain.at(t).period;
+		tl.dfa.assign(W, dfa.at(t).initial());
+		tl.bad.assign(W, 0);
+		tl.carry.assign(W, NO_DATA);
+		tl.held.assign(W, NO_DATA);
+		tl.first.assign(W, 0);
+		tl.out.assign((size_t)rows * W, NO_DATA);
+	}
+
+	// Tail: state of the effective jobs
+	vector<double> last_stamp(W, NO_DATA), last_release(W, NO_DATA);
+
+	for (double S0 = 0; S0 < horizon; S0 += segment) {
+		const double S1 = S0 + segment;
+
+		for (int t = 0; t < N; t++) {
+			TaskLanes &tl = task[t];
+			const double T = taskchain.at(t).period;
+			const double D = taskchain.at(t).deadline;
+			const MissModel &mm = miss.at(t);
+			const WHautomaton &a = dfa.at(t);
+			const double A = S0 - shift[t], B = S1 - shift[t];
+			const int rows = tl.out.size() / W;
+
+			const TaskLanes *prod = (t > 0) ? &task[t - 1] : NULL;
+			const double Tp = (t > 0) ? taskchain.at(t - 1).period : 1;
+			const double Dp = (t > 0) ? taskchain.at(t - 1).deadline : 0;
+			const long long prod_rows = (t > 0) ? (long long)(prod->out.size() / W) : 0;
+			const bool tail = (t == N - 1);
+
+			for (int l = 0; l < W; l++) {
+				tl.first[l] = (long long)max(0.0, ceil((A - tl.offset[l]) / T));
+				tl.carry[l] = tl.held[l];
+			}
+
+			for (int r = 0; r < rows; r++) {
+
+				// Jobs of this row released in the segment
+				for (int l = 0; l < W; l++)
+					valid[l] = (tl.offset[l] + (tl.first[l] + r) * T < B);
+
+				// Outcomes
+				if (hard.at(t)) {
+					fill(missed.begin(), missed.end(), 0);
+				}
+				else if (mm.process == MISS_BERNOULLI) {
+					for (int l = 0; l < W; l++) {
+						uint8_t m = valid[l] && uniform(rng[l]) < mm.p_miss;
+						m = m && a.next(tl.dfa[l], m) != WH_DEAD_STATE;		// inadmissible miss: the job hits
+						missed[l] = m;
+						if (valid[l])
+							tl.dfa[l] = a.next(tl.dfa[l], m);
+					}
+				}
+				else {
+					for (int l = 0; l < W; l++) {
+						uint8_t m = valid[l] && uniform(rng[l]) < (tl.bad[l] ? mm.p_miss : mm.p_miss_good);
+						m = m && a.next(tl.dfa[l], m) != WH_DEAD_STATE;
+						missed[l] = m;
+						if (valid[l]) {
+							tl.dfa[l] = a.next(tl.dfa[l], m);
+							double flip = uniform(rng[l]);
+							tl.bad[l] = tl.bad[l] ? (flip >= mm.p_leave_bad) : (flip < mm.p_enter_bad);
+						}
+					}
+				}
+
+				// Data read at release, data held after the job
+				double *out = &tl.out[(size_t)r * W];
+				for (int l = 0; l < W; l++) {
+					const double release = tl.offset[l] + (tl.first[l] + r) * T;
+					double read;
+					if (prod == NULL) {
+						read = release;
+					}
+					else {
+						// Last producer job completed at or before the release
+						double k = floor((release - prod->offset[l] - Dp) / Tp);
+						// (only lanes past the end of their segment may point past the producer rows)
+						long long row = min((long long)k - prod->first[l], prod_rows - 1);
+						read = (k < 0) ? NO_DATA : ((row < 0) ? prod->carry[l] : prod->out[(size_t)row * W + l]);
+					}
+					out[l] = missed[l] ? tl.held[l] : read;
+					if (valid[l])
+						tl.held[l] = out[l];
+				}
+
+				if (!tail)
+					continue;
+
+				// Samples on effective tail jobs
+				for (int l = 0; l < lanes; l++) {
+					const double release = tl.offset[l] + (tl.first[l] + r) * T;
+					const double stamp = out[l];
+					if (!valid[l] || missed[l] || stamp == NO_DATA || stamp <= last_stamp[l] || release > horizon)
+						continue;
+
+					if (stamp >= warmup) {
+						h.latency.add(release + D - stamp);
+						if (last_stamp[l] >= warmup) {
+							h.dataage.add(release - last_stamp[l]);
+							h.updateint.add(release - last_release[l]);
+						}
+					}
+					last_stamp[l] = stamp;
+					last_release[l] = release;
+				}
+			}
+
+			for (int l = 0; l < lanes; l++)
+				h.activations += (uint64_t)max(0.0, ceil((B - tl.offset[l]) / T)) - tl.first[l];
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// SIMULATION
+//-----------------------------------------------------------------------------
+
+SimResult simulate_chain(const vector<Task> &taskchain, const vector<WHconstr> &setofmk, const SimOptions &sopts)
+{
+	auto start_time = chrono::steady_clock::now();
+
+	SimResult res;
+	res.latency = Histogram(sopts.bin_width);
+	res.dataage = Histogram(sopts.bin_width);
+	res.updateint = Histogram(sopts.bin_width);
+
+	const int N = taskchain.size();
+	if (N == 0 || sopts.runs <= 0)
+		return res;
+
+	// Admissible miss sequences and miss process of each task
+	vector<WHautomaton> dfa;
+	vector<MissModel> miss;
+	vector<bool> hard(N);
+	double maxT = 0, warmup = 0;
+	for (int t = 0; t < N; t++) {
+		dfa.push_back(WHautomaton(setofmk.at(t)));
+		miss.push_back(t < sopts.task_miss.size() ? sopts.task_miss.at(t) : sopts.miss);
+		hard[t] = (dfa.back().next(dfa.back().initial(), true) == WH_DEAD_STATE);
+		maxT = max(maxT, (double)taskchain.at(t).period);
+
+		// Long enough for data to cross the chain under the longest admissible run of misses
+		warmup += (setofmk.at(t).mconsec + 2) * taskchain.at(t).period + taskchain.at(t).deadline;
+	}
+	if (sopts.warmup >= 0)
+		warmup = sopts.warmup;
+
+	const double horizon = (sopts.horizon > 0) ? sopts.horizon : 1000 * maxT;
+
+	// Jobs per task and segment bounded by SIM_SEGMENT_JOBS
+	double minT = maxT;
+	for (int t = 0; t < N; t++)
+		minT = min(minT, (double)taskchain.at(t).period);
+	const double segment = SIM_SEGMENT_JOBS * minT;
+
+	// Batches of lanes, shared among the threads
+	const long long num_batches = (sopts.runs + SIM_LANES - 1) / SIM_LANES;
+	int num_threads = (sopts.threads > 0) ? sopts.threads : max(1u, thread::hardware_concurrency());
+	num_threads = (int)min((long long)num_threads, num_batches);
+
+	atomic<long long> next_batch(0);
+	mutex mtx;
+	vector<thread> workers;
+
+	for (int w = 0; w < num_threads; w++) {
+		workers.push_back(thread([&]() {
+			Histograms h(sopts.bin_width);
+			long long b;
+			while ((b = next_batch++) < num_batches) {
+				int lanes = (int)min((long long)SIM_LANES, sopts.runs - b * SIM_LANES);
+				simulate_batch(taskchain, dfa, miss, hard, horizon, warmup, segment,
+					sopts.seed + 0x9E3779B97F4A7C15ULL * (b + 1), lanes, h);
+			}
+
+			lock_guard<mutex> lock(mtx);
+			res.latency.merge(h.latency);
+			res.dataage.merge(h.dataage);
+			res.updateint.merge(h.updateint);
+			res.activations += h.activations;
+		}));
+	}
+	for (int w = 0; w < workers.size(); w++)
+		workers.at(w).join();
+
+	auto end_time = chrono::steady_clock::now();
+	res.runtime = chrono::duration<double>(end_time - start_time).count();
+
+	return res;
+}
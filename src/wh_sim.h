@@ -0,0 +1,99 @@
+#ifndef WH_SIM_H__
+#define WH_SIM_H__
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#include "milp_data.h"
+
+//-----------------------------------------------------------------------------
+// Monte Carlo simulation of a chain under stochastic deadline misses
+//
+// Same semantics as the MILP: jobs are released periodically (head offset 0, random offsets for
+// the others), a job that meets its deadline writes at release + D the data it read at release,
+// a job that misses writes nothing. Misses follow a stochastic process filtered by the WHautomaton
+// of the task, so every simulated sequence satisfies the (m,k) constraints; hard tasks never miss.
+// Samples are taken on the effective tail jobs (those delivering data newer than the previous one):
+//   latency:         completion of the tail job - release of the head job of its data
+//   data age:        release of the next effective tail job - release of the head job of the data
+//   update interval: between the releases of two consecutive effective tail jobs
+//
+// Runs are simulated in batches of SIM_LANES lanes, time segment after time segment, with all job
+// state stored as structure of arrays (job-major, lane-minor) so that inner loops run over lanes.
+//-----------------------------------------------------------------------------
+
+#define SIM_LANES 256
+
+enum MissProcess {
+	MISS_BERNOULLI = 0,		// independent misses with probability p_miss
+	MISS_MARKOV = 1			// two-state chain (Gilbert-Elliott): good and bad state
+};
+
+struct MissModel {
+	MissProcess process = MISS_BERNOULLI;
+	double p_miss = 0.1;			// miss probability (bad state for MISS_MARKOV)
+	double p_miss_good = 0.0;		// miss probability in the good state
+	double p_enter_bad = 0.05;		// good -> bad, per job
+	double p_leave_bad = 0.5;		// bad -> good, per job
+};
+
+struct SimOptions {
+	long long runs = 10000;			// independent runs (random offsets and misses)
+	double horizon = 0;				// simulated time per run (0: 1000 times the largest period)
+	double warmup = -1;				// samples before this time are dropped (<0: from the constraints)
+	int threads = 0;				// 0: hardware concurrency
+	uint64_t seed = 1;
+	double bin_width = 1;			// histogram resolution, time units
+	MissModel miss;					// miss process of every task...
+	std::vector<MissModel> task_miss;	// ...unless given per task
+};
+
+class Histogram {
+public:
+	explicit Histogram(double bin_width = 1) : width(bin_width), samples(0), sum(0), lo(0), hi(0) {}
+
+	void add(double value) {
+		size_t bin = (value > 0) ? (size_t)(value / width) : 0;
+		if (bin >= counts.size())
+			counts.resize(bin + 1, 0);
+		counts[bin]++;
+		lo = (samples == 0) ? value : std::min(lo, value);
+		hi = (samples == 0) ? value : std::max(hi, value);
+		sum += value;
+		samples++;
+	}
+
+	void merge(const Histogram &other);
+
+	// Upper edge of the bin holding quantile q in [0,1]
+	double percentile(double q) const;
+
+	uint64_t count() const { return samples; }
+	double mean() const { return samples ? sum / samples : 0; }
+	double min() const { return lo; }
+	double max() const { return hi; }
+	double bin_width() const { return width; }
+	const std::vector<uint64_t>& bins() const { return counts; }
+
+private:
+	double width;
+	std::vector<uint64_t> counts;
+	uint64_t samples;
+	double sum;
+	double lo, hi;
+};
+
+struct SimResult {
+	Histogram latency;
+	Histogram dataage;
+	Histogram updateint;
+	uint64_t activations = 0;		// simulated jobs, all tasks and runs
+	double runtime = 0;				// wall-clock seconds
+};
+
+// Throws std::length_error if a constraint cannot be compiled (see WHautomaton)
+SimResult simulate_chain(const std::vector<Task> &taskchain, const std::vector<WHconstr> &setofmk,
+	const SimOptions &sopts);
+
+#endif